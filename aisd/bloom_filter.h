@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//SSE2 detection shared with the SIMD key scans of the labs
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#ifndef AISD_SSE2
+#define AISD_SSE2
+#endif
+#endif
+
+//blocked bloom filter: all bits of a key are set inside one 512-bit block,
+//so a negative lookup touches a single cache line.
+//keys are passed as 64-bit hashes; the filter mixes them itself
+class BloomFilter {
+	struct alignas(64) Block {
+		uint64_t words[8];
+	};
+
+	std::vector<Block> _blocks;
+	size_t _hashes;
+	size_t _count;
+	//keys the filter is currently sized for, and the smallest size the owner asked for
+	size_t _capacity;
+	size_t _expected;
+	double _bitsPerKey;
+
+	//splitmix64 finalizer, spreads weak hashes such as identity hash of int
+	static uint64_t mix(uint64_t h) {
+		h ^= h >> 30;
+		h *= 0xBF58476D1CE4E5B9ull;
+		h ^= h >> 27;
+		h *= 0x94D049BB133111EBull;
+		h ^= h >> 31;
+		return h;
+	}
+
+	size_t blockIndex(uint64_t h) const {
+		return static_cast<size_t>((h >> 32) * _blocks.size() >> 32);
+	}
+
+	//_hashes bit positions inside the block, 9 bits each
+	void makeMask(uint64_t h, Block& mask) const {
+		uint64_t bits = mix(h ^ 0x9E3779B97F4A7C15ull);
+
+		for (size_t i = 0; i < 8; ++i)
+			mask.words[i] = 0;
+
+		for (size_t i = 0, used = 0; i < _hashes; ++i, used += 9) {
+			if (used + 9 > 64) {
+				bits = mix(bits);
+				used = 0;
+			}
+			size_t bit = (bits >> used) & 511;
+			mask.words[bit / 64] |= uint64_t(1) << (bit % 64);
+		}
+	}
+
+	void resize(size_t keys) {
+		_capacity = keys;
+		_blocks.resize(static_cast<size_t>(std::ceil(_bitsPerKey * keys / 512)) + 1);
+		clear();
+	}
+
+public:
+	//sized for expected_keys keys at the given false positive rate
+	BloomFilter(size_t expected_keys, double false_positive_rate) : _count(0) {
+		if (expected_keys == 0)
+			expected_keys = 1;
+		if (!(false_positive_rate > 0 && false_positive_rate < 1))
+			false_positive_rate = 0.01;
+
+		double ln2 = std::log(2.0);
+		double bits_per_key = -std::log(false_positive_rate) / (ln2 * ln2);
+		double hashes = std::round(bits_per_key * ln2);
+
+		_hashes = hashes < 1 ? 1 : hashes > 16 ? 16 : static_cast<size_t>(hashes);
+		_bitsPerKey = bits_per_key;
+		_expected = expected_keys;
+		resize(expected_keys);
+	}
+
+	//true once the filter no longer describes live_keys keys at its rate:
+	//erased keys make up more than half of it, or it holds more keys than it was sized for
+	bool needs_rebuild(size_t live_keys) const {
+		return _count > 2 * live_keys + 64 || _count > _capacity;
+	}
+
+	//empties the filter and sizes it for live_keys keys about to be added again,
+	//with room to double so that a growing owner rebuilds O(log n) times
+	void reset(size_t live_keys) {
+		resize(live_keys * 2 > _expected ? live_keys * 2 : _expected);
+	}
+
+	void add(uint64_t hash) {
+		uint64_t h = mix(hash);
+		Block mask;
+		makeMask(h, mask);
+
+		Block& block = _blocks[blockIndex(h)];
+		for (size_t i = 0; i < 8; ++i)
+			block.words[i] |= mask.words[i];
+
+		++_count;
+	}
+
+	//false means the key was never added
+	bool may_contain(uint64_t hash) const {
+		uint64_t h = mix(hash);
+		Block mask;
+		makeMask(h, mask);
+		const Block& block = _blocks[blockIndex(h)];
+
+#ifdef AISD_SSE2
+		__m128i missing = _mm_setzero_si128();
+
+		for (size_t i = 0; i < 8; i += 2) {
+			__m128i bits = _mm_load_si128(reinterpret_cast<const __m128i*>(block.words + i));
+			__m128i wanted = _mm_load_si128(reinterpret_cast<const __m128i*>(mask.words + i));
+			missing = _mm_or_si128(missing, _mm_andnot_si128(bits, wanted));
+		}
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xFFFF;
+#else
+		uint64_t missing = 0;
+
+		for (size_t i = 0; i < 8; ++i)
+			missing |= mask.words[i] & ~block.words[i];
+
+		return missing == 0;
+#endif
+	}
+
+	void clear() {
+		for (Block& block : _blocks) {
+			for (size_t i = 0; i < 8; ++i)
+				block.words[i] = 0;
+		}
+		_count = 0;
+	}
+
+	//number of add calls since the last clear
+	size_t count() const {
+		return _count;
+	}
+
+	size_t memory_bytes() const {
+		return _blocks.size() * sizeof(Block);
+	}
+
+	//estimated false positive rate for the current number of keys
+	double false_positive_rate() const {
+		double bits = static_cast<double>(_blocks.size()) * 512;
+		return std::pow(1 - std::exp(-static_cast<double>(_hashes) * _count / bits), static_cast<double>(_hashes));
+	}
+};
@@ -3,185 +3,638 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "bloom_filter.h"
+#include "roaring_set.h"
 
 using namespace std;
 
+//linear scan of an array of keys: generic version
+template<typename Key>
+struct KeyScan {
+	static size_t count(const Key* keys, size_t n, const Key& key) {
+		size_t result = 0;
+
+		for (size_t i = 0; i < n; ++i)
+			result += (keys[i] == key);
+
+		return result;
+	}
+};
+
+#ifdef AISD_SSE2
+//int keys are compared 4 at a time with SSE2
+template<>
+struct KeyScan<int> {
+	static_assert(sizeof(int) == 4, "SSE2 scan expects 32-bit int");
+
+	static size_t count(const int* keys, size_t n, int key) {
+		__m128i needle = _mm_set1_epi32(key);
+		__m128i matches = _mm_setzero_si128();
+		size_t i = 0;
+
+		//each equal lane is -1, so subtracting accumulates the count per lane
+		for (; i + 4 <= n; i += 4) {
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+			matches = _mm_sub_epi32(matches, _mm_cmpeq_epi32(block, needle));
+		}
+
+		alignas(16) int lanes[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes), matches);
+		size_t result = size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+
+		for (; i < n; ++i)
+			result += (keys[i] == key);
+
+		return result;
+	}
+};
+#endif
+
+//allocators that may allocate and deallocate from several threads at once;
+//specialize for other thread-safe allocators to let tree set operations run in parallel
+template<typename Alloc>
+struct is_thread_safe_allocator : false_type {};
+
+template<typename T>
+struct is_thread_safe_allocator<allocator<T>> : true_type {};
+
+//binary search tree balanced as a treap: every node has a random priority
+//and priorities form a max-heap, so the expected depth is O(log n)
+template<typename Key, typename Compare = less<Key>, typename Alloc = allocator<Key>>
 class BinaryTree {
 	struct Node {
-		int _key;
-		Node* _left;
-		Node* _right;
-
-		Node(int key) : _key(key), _left(nullptr), _right(nullptr) {}
+		Key _key;
+		size_t _priority;
+		size_t _count;
+		//[0] - left subtree (smaller keys), [1] - right subtree; an array lets
+		//the descent index the child with the comparison result
+		Node* _child[2];
+
+		template<typename K>
+		Node(K&& key, size_t priority) : _key(std::forward<K>(key)), _priority(priority), _count(1), _child{ nullptr, nullptr } {}
 	};
 
+	using NodeAlloc = typename allocator_traits<Alloc>::template rebind_alloc<Node>;
+	using NodeTraits = allocator_traits<NodeAlloc>;
+
+	//arithmetic keys with the default ordering use the branchless descent
+	static constexpr bool _branchless = is_arithmetic<Key>::value && is_same<Compare, less<Key>>::value;
+
+	//set operations recurse in parallel only for inputs at least this large,
+	//and only when the allocator can be shared between threads (an arena cannot)
+	static constexpr size_t _parallelThreshold = 1 << 15;
+	static constexpr bool _parallelAlloc = is_thread_safe_allocator<NodeAlloc>::value;
+
+	//the membership filter needs std::hash for the key type
+	static constexpr bool _filterable = is_default_constructible<hash<Key>>::value;
+
 	Node* _root;
+	size_t _seed;
+	Compare _comp;
+	NodeAlloc _alloc;
+	unique_ptr<BloomFilter> _filter;
 
-	void destroy(Node* node) {
+	static uint64_t keyHash(const Key& key) {
+		return hash<Key>{}(key);
+	}
+
+	void fillFilter(Node* node) {
 		if (node) {
-			destroy(node->_left);
-			destroy(node->_right);
-			delete node;
+			_filter->add(keyHash(node->_key));
+			fillFilter(node->_child[0]);
+			fillFilter(node->_child[1]);
 		}
 	}
 
-	Node* insert(Node* node, int key) {
-		if (!node)
-			return new Node(key);
+	//erased keys stay in the filter and new ones may outgrow its size,
+	//the filter tells when it has to be refilled from the live keys
+	void refreshFilter() {
+		if constexpr (_filterable) {
+			if (_filter && _filter->needs_rebuild(size())) {
+				_filter->reset(size());
+				fillFilter(_root);
+			}
+		}
+	}
 
-		if (key < node->_key)
-			node->_left = insert(node->_left, key);
-		else if (key > node->_key)
-			node->_right = insert(node->_right, key);
+	//number of keys in a subtree
+	static size_t count(const Node* node) {
+		return node ? node->_count : 0;
+	}
 
+	//recompute the subtree size after the children changed
+	static Node* update(Node* node) {
+		node->_count = 1 + count(node->_child[0]) + count(node->_child[1]);
 		return node;
 	}
 
-	bool contains(Node* node, int key) {
+	//xorshift generator for node priorities
+	size_t nextPriority() {
+		_seed ^= _seed << 13;
+		_seed ^= _seed >> 7;
+		_seed ^= _seed << 17;
+		return _seed;
+	}
+
+	template<typename K>
+	Node* createNode(K&& key, size_t priority) {
+		Node* node = NodeTraits::allocate(_alloc, 1);
+
+		try {
+			NodeTraits::construct(_alloc, node, std::forward<K>(key), priority);
+		}
+		catch (...) {
+			NodeTraits::deallocate(_alloc, node, 1);
+			throw;
+		}
+		return node;
+	}
+
+	void destroyNode(Node* node) {
+		NodeTraits::destroy(_alloc, node);
+		NodeTraits::deallocate(_alloc, node, 1);
+	}
+
+	void destroy(Node* node) {
+		if (node) {
+			destroy(node->_child[0]);
+			destroy(node->_child[1]);
+			destroyNode(node);
+		}
+	}
+
+	static Node* rotateRight(Node* node) {
+		Node* left = node->_child[0];
+		node->_child[0] = left->_child[1];
+		left->_child[1] = update(node);
+		return update(left);
+	}
+
+	static Node* rotateLeft(Node* node) {
+		Node* right = node->_child[1];
+		node->_child[1] = right->_child[0];
+		right->_child[0] = update(node);
+		return update(right);
+	}
+
+	Node* insert(Node* node, const Key& key) {
 		if (!node)
-			return false;
+			return createNode(key, nextPriority());
 
-		if (key == node->_key)
-			return true;
+		if (_comp(key, node->_key)) {
+			node->_child[0] = insert(node->_child[0], key);
+			update(node);
+			if (node->_child[0]->_priority > node->_priority)
+				node = rotateRight(node);
+		}
+		else if (_comp(node->_key, key)) {
+			node->_child[1] = insert(node->_child[1], key);
+			update(node);
+			if (node->_child[1]->_priority > node->_priority)
+				node = rotateLeft(node);
+		}
+
+		return node;
+	}
 
-		return (key < node->_key) ? contains(node->_left, key) : contains(node->_right, key);
+	bool contains(Node* node, const Key& key) const {
+		if constexpr (_branchless) {
+			//lower bound search: the comparison result indexes the child array,
+			//the only branch left is the loop exit
+			Node* candidate = nullptr;
+
+			while (node) {
+				bool right = node->_key < key;
+				candidate = right ? candidate : node;
+				node = node->_child[right];
+			}
+			return candidate && !(key < candidate->_key);
+		}
+		else {
+			while (node) {
+				if (_comp(key, node->_key))
+					node = node->_child[0];
+				else if (_comp(node->_key, key))
+					node = node->_child[1];
+				else
+					return true;
+			}
+			return false;
+		}
 	}
 
-	Node* erase(Node* node, int key) {
+	Node* erase(Node* node, const Key& key) {
 		if (!node)
 			return nullptr;
 
-		if (key < node->_key) {
-			node->_left = erase(node->_left, key);
+		if (_comp(key, node->_key)) {
+			node->_child[0] = erase(node->_child[0], key);
 		}
-		else if (key > node->_key) {
-			node->_right = erase(node->_right, key);
+		else if (_comp(node->_key, key)) {
+			node->_child[1] = erase(node->_child[1], key);
 		}
 		else {
-			//if node don't have child or have 1 child
-			if (!node->_left) {
-				Node* temp = node->_right;
-				delete node;
-				return temp;
-			}
-			else if (!node->_right) {
-				Node* temp = node->_left;
-				delete node;
-				return temp;
-			}
+			//children are joined in place of the deleted node
+			Node* temp = join(node->_child[0], node->_child[1]);
+			destroyNode(node);
+			return temp;
+		}
+		return update(node);
+	}
 
-			//if node have 2 children
-			Node* temp = minValueNode(node->_right);
-			node->_key = temp->_key;
-			node->_right = erase(node->_right, temp->_key);
+	//split a subtree into keys less than and greater than key,
+	//the node equal to key (if any) is returned in mid
+	void split(Node* node, const Key& key, Node*& left, Node*& mid, Node*& right) const {
+		if (!node) {
+			left = mid = right = nullptr;
+		}
+		else if (_comp(key, node->_key)) {
+			split(node->_child[0], key, left, mid, node->_child[0]);
+			right = update(node);
+		}
+		else if (_comp(node->_key, key)) {
+			split(node->_child[1], key, node->_child[1], mid, right);
+			left = update(node);
+		}
+		else {
+			left = node->_child[0];
+			right = node->_child[1];
+			mid = node;
+			mid->_child[0] = mid->_child[1] = nullptr;
+			update(mid);
 		}
-		return node;
 	}
 
-	//helper function to delete a node with 2 children
-	Node* minValueNode(Node* node) {
-		Node* current = node;
+	//join two subtrees where every key of left is less than every key of right
+	static Node* join(Node* left, Node* right) {
+		if (!left) return right;
+		if (!right) return left;
 
-		while (current && current->_left)
-			current = current->_left;
+		if (left->_priority > right->_priority) {
+			left->_child[1] = join(left->_child[1], right);
+			return update(left);
+		}
+		right->_child[0] = join(left, right->_child[0]);
+		return update(right);
+	}
 
-		return current;
+	//join with a single node whose key lies between the two subtrees
+	static Node* join(Node* left, Node* mid, Node* right) {
+		return join(join(left, mid), right);
 	}
 
-	void print(Node* node) {
+	//run both halves of a recursion, on two threads while forks remain
+	template<typename Left, typename Right>
+	static void fork(int forks, Left left, Right right) {
+		if (forks > 0) {
+			auto task = async(launch::async, left);
+			right();
+			task.get();
+		}
+		else {
+			left();
+			right();
+		}
+	}
+
+	static int forksFor(size_t work) {
+		if (!_parallelAlloc || work < _parallelThreshold)
+			return 0;
+
+		int forks = 0;
+		for (unsigned threads = thread::hardware_concurrency(); threads > 1; threads /= 2)
+			++forks;
+
+		return forks;
+	}
+
+	//both trees are consumed, used when the nodes of other can be adopted
+	Node* unite(Node* a, Node* b, int forks) {
+		if (!a) return b;
+		if (!b) return a;
+
+		if (a->_priority < b->_priority)
+			swap(a, b);
+
+		Node *left, *mid, *right;
+		split(b, a->_key, left, mid, right);
+
+		if (mid)
+			destroyNode(mid);
+
+		fork(forks,
+			[&] { a->_child[0] = unite(a->_child[0], left, forks - 1); },
+			[&] { a->_child[1] = unite(a->_child[1], right, forks - 1); });
+
+		return update(a);
+	}
+
+	//the set operations below consume a and only read b: a is split by the keys
+	//of b, and the recursion stops as soon as either side is empty, so the work
+	//follows the smaller tree instead of cloning b first
+
+	//keys of b missing from a are copied
+	Node* uniteCopy(Node* a, const Node* b, int forks) {
+		if (!b) return a;
+		if (!a) return copy(b);
+
+		Node *left, *mid, *right;
+		split(a, b->_key, left, mid, right);
+
+		if (!mid)
+			mid = createNode(b->_key, b->_priority);
+
+		fork(forks,
+			[&] { left = uniteCopy(left, b->_child[0], forks - 1); },
+			[&] { right = uniteCopy(right, b->_child[1], forks - 1); });
+
+		return join(left, mid, right);
+	}
+
+	Node* intersect(Node* a, const Node* b, int forks) {
+		if (!a)
+			return nullptr;
+		if (!b) {
+			destroy(a);
+			return nullptr;
+		}
+
+		Node *left, *mid, *right;
+		split(a, b->_key, left, mid, right);
+
+		fork(forks,
+			[&] { left = intersect(left, b->_child[0], forks - 1); },
+			[&] { right = intersect(right, b->_child[1], forks - 1); });
+
+		return mid ? join(left, mid, right) : join(left, right);
+	}
+
+	Node* subtract(Node* a, const Node* b, int forks) {
+		if (!a || !b)
+			return a;
+
+		Node *left, *mid, *right;
+		split(a, b->_key, left, mid, right);
+
+		if (mid)
+			destroyNode(mid);
+
+		fork(forks,
+			[&] { left = subtract(left, b->_child[0], forks - 1); },
+			[&] { right = subtract(right, b->_child[1], forks - 1); });
+
+		return join(left, right);
+	}
+
+	void print(Node* node) const {
 		if (node) {
-			print(node->_left);
+			print(node->_child[0]);
 			cout << node->_key << " ";
-			print(node->_right);
+			print(node->_child[1]);
 		}
 	}
 
-	Node* copy(Node* node) {
+	Node* copy(const Node* node) {
 		if (node == nullptr)
 			return nullptr;
 
-		Node* new_node = new Node(node->_key);
-		new_node->_left = copy(node->_left);
-		new_node->_right = copy(node->_right);
+		Node* new_node = createNode(node->_key, node->_priority);
+		new_node->_child[0] = copy(node->_child[0]);
+		new_node->_child[1] = copy(node->_child[1]);
+		new_node->_count = node->_count;
 
 		return new_node;
 	}
 
-	int size(Node* node) {
-		if (!node)
-			return 0;
+	//same shape with the keys of another tree's nodes moved into nodes of this allocator
+	Node* moveNodes(Node* node) {
+		if (node == nullptr)
+			return nullptr;
 
-		return 1 + size(node->_left) + size(node->_right);
+		Node* new_node = createNode(move(node->_key), node->_priority);
+		new_node->_child[0] = moveNodes(node->_child[0]);
+		new_node->_child[1] = moveNodes(node->_child[1]);
+		new_node->_count = node->_count;
+
+		return new_node;
 	}
 
-	void toVector(Node* node, vector<int>& vec) {
+	void toVector(Node* node, vector<Key>& vec) const {
 		if (!node) return;
 
-		toVector(node->_left, vec);
+		toVector(node->_child[0], vec);
 		vec.push_back(node->_key);
-		toVector(node->_right, vec);
+		toVector(node->_child[1], vec);
+	}
+
+	//nodes of other can be reused when its allocator can free them
+	bool canAdopt(const BinaryTree& other) const {
+		return NodeTraits::is_always_equal::value || _alloc == other._alloc;
 	}
 
 public:
-	BinaryTree() : _root(nullptr) {}
+	explicit BinaryTree(const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+		: _root(nullptr), _seed(0x9E3779B97F4A7C15ull), _comp(comp), _alloc(alloc) {}
 
 	//copy constructor
-	BinaryTree(const BinaryTree& other) {
+	BinaryTree(const BinaryTree& other)
+		: _root(nullptr), _seed(other._seed), _comp(other._comp),
+		  _alloc(NodeTraits::select_on_container_copy_construction(other._alloc)),
+		  _filter(other._filter ? make_unique<BloomFilter>(*other._filter) : nullptr) {
 		_root = copy(other._root);
 	}
 
+	//move constructor
+	BinaryTree(BinaryTree&& other) noexcept
+		: _root(other._root), _seed(other._seed), _comp(move(other._comp)), _alloc(move(other._alloc)),
+		  _filter(move(other._filter)) {
+		other._root = nullptr;
+	}
+
 	//destructor
 	~BinaryTree() {
 		destroy(_root);
 	}
 
-	//assignment operator
+	//assignment operator; the allocator is copied only if it propagates on copy assignment
 	BinaryTree& operator=(const BinaryTree& other) {
 		if (this != &other) {
 			destroy(_root);
 			_root = nullptr;
+			if constexpr (NodeTraits::propagate_on_container_copy_assignment::value)
+				_alloc = other._alloc;
 			_root = copy(other._root);
+			_comp = other._comp;
+			_filter = other._filter ? make_unique<BloomFilter>(*other._filter) : nullptr;
+		}
+		return *this;
+	}
+
+	//move assignment operator: the nodes are adopted when the allocator propagates
+	//on move assignment or compares equal, otherwise the keys are moved one by one
+	BinaryTree& operator=(BinaryTree&& other)
+		noexcept(NodeTraits::propagate_on_container_move_assignment::value || NodeTraits::is_always_equal::value) {
+		if (this != &other) {
+			destroy(_root);
+			_root = nullptr;
+			_comp = move(other._comp);
+			_filter = move(other._filter);
+
+			if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+				_alloc = move(other._alloc);
+				_root = other._root;
+			}
+			else if (canAdopt(other)) {
+				_root = other._root;
+			}
+			else {
+				_root = moveNodes(other._root);
+				other.destroy(other._root);
+			}
+			other._root = nullptr;
 		}
 		return *this;
 	}
 
 	//print content
-	void print() {
+	void print() const {
 		print(_root);
 		cout << endl;
 	}
 
 	//element presence check
-	bool contains(int key) {
+	bool contains(const Key& key) const {
+		if constexpr (_filterable) {
+			if (_filter && !_filter->may_contain(keyHash(key)))
+				return false;
+		}
 		return contains(_root, key);
 	}
 
 	//insert element
-	bool insert(int key) {
+	bool insert(const Key& key) {
 		if (!contains(key)) {
 			_root = insert(_root, key);
+			if constexpr (_filterable) {
+				if (_filter)
+					_filter->add(keyHash(key));
+			}
+			refreshFilter();
 			return true;
 		}
 		return false;
 	}
 
 	//delete element
-	bool erase(int key) {
+	bool erase(const Key& key) {
 		if (contains(key)) {
 			_root = erase(_root, key);
+			refreshFilter();
 			return true;
 		}
 		return false;
 	}
 
-	int size() {
-		size(_root);
+	//bloom filter in front of contains: most misses return after
+	//touching one cache line instead of walking a tree path
+	void enableFilter(size_t expectedKeys, double falsePositiveRate) {
+		static_assert(_filterable, "membership filter requires std::hash<Key>");
+		_filter = make_unique<BloomFilter>(expectedKeys, falsePositiveRate);
+		if (_filter->needs_rebuild(size()))
+			_filter->reset(size());
+		fillFilter(_root);
+	}
+
+	void disableFilter() {
+		_filter.reset();
 	}
 
-	void toVector(vector<int>& vec) {
+	//filter statistics (memory, expected false positive rate), nullptr if disabled
+	const BloomFilter* filter() const {
+		return _filter.get();
+	}
+
+	size_t size() const {
+		return count(_root);
+	}
+
+	void toVector(vector<Key>& vec) const {
 		toVector(_root, vec);
 	}
+
+	//set operations are built on split/join and take O(m log(n/m + 1))
+	//expected work for trees of sizes m <= n (plus the keys copied into
+	//this tree by union_with); large inputs recurse in parallel
+
+	//add all keys of other
+	void union_with(const BinaryTree& other) {
+		if (this == &other)
+			return;
+
+		if constexpr (_filterable) {
+			if (_filter)
+				fillFilter(other._root);
+		}
+		_root = uniteCopy(_root, other._root, forksFor(size() + other.size()));
+		refreshFilter();
+	}
+
+	void union_with(BinaryTree&& other) {
+		if (this == &other || !canAdopt(other))
+			return union_with(static_cast<const BinaryTree&>(other));
+
+		if constexpr (_filterable) {
+			if (_filter)
+				fillFilter(other._root);
+		}
+		_root = unite(_root, other._root, forksFor(size() + other.size()));
+		other._root = nullptr;
+		refreshFilter();
+	}
+
+	//keep only keys that are also in other
+	void intersect_with(const BinaryTree& other) {
+		if (this == &other)
+			return;
+
+		_root = intersect(_root, other._root, forksFor(min(size(), other.size())));
+		refreshFilter();
+	}
+
+	//remove all keys of other
+	void difference(const BinaryTree& other) {
+		if (this == &other) {
+			destroy(_root);
+			_root = nullptr;
+			return;
+		}
+
+		_root = subtract(_root, other._root, forksFor(min(size(), other.size())));
+		refreshFilter();
+	}
+
+	//keys greater than key are moved to the returned tree, the rest stay
+	BinaryTree split(const Key& key) {
+		BinaryTree greater(_comp, _alloc);
+		greater._seed = nextPriority();
+
+		Node *left, *mid, *right;
+		split(_root, key, left, mid, right);
+
+		_root = join(left, mid);
+		greater._root = right;
+		refreshFilter();
+		return greater;
+	}
 };
 
 //Вариант 4: для заданного std::vector<int> верните новый std::vector<int>, 
@@ -189,16 +642,10 @@ public:
 //должен быть {3 4} )
 
 vector<int> getUniqueElements(const vector<int>& vec) {
-	BinaryTree tree;
+	BinaryTree<int> tree;
 
 	for (size_t i = 0; i < vec.size(); ++i) {
-		int num = vec[i];
-		int count = 0;
-
-		for (size_t j = 0; j < vec.size(); ++j) {
-			if (vec[j] == num)
-				count++;
-		}
+		size_t count = KeyScan<int>::count(vec.data(), vec.size(), vec[i]);
 
 		if (count == 1)
 			tree.insert(vec[i]);
@@ -220,8 +667,9 @@ size_t lcg() {
 	return x;
 }
 
-//generate unique random numbers and fill the tree
-void fillTreeWithUniqueRandomNumbers(BinaryTree& tree, size_t count) {
+//generate unique random numbers and fill the tree (or any set of ints)
+template<typename Set>
+void fillTreeWithUniqueRandomNumbers(Set& tree, size_t count) {
 	vector<int> unique_numbers;
 
 	while (unique_numbers.size() < count) {
@@ -233,11 +681,12 @@ void fillTreeWithUniqueRandomNumbers(BinaryTree& tree, size_t count) {
 }
 
 //average time to fill a tree
+template<typename Set = BinaryTree<int>>
 double measureFillTime(size_t count, size_t trials) {
 	double total_time = 0;
 
 	for (size_t i = 0; i < trials; ++i) {
-		BinaryTree tree;
+		Set tree;
 
 		auto start = chrono::high_resolution_clock::now();
 		fillTreeWithUniqueRandomNumbers(tree, count);
@@ -248,7 +697,8 @@ double measureFillTime(size_t count, size_t trials) {
 }
 
 //average search time
-double measureSearchTime(BinaryTree& tree, size_t trials) {
+template<typename Set>
+double measureSearchTime(const Set& tree, size_t trials) {
 	double total_time = 0;
 
 	for (size_t i = 0; i < trials; ++i) {
@@ -264,7 +714,7 @@ double measureSearchTime(BinaryTree& tree, size_t trials) {
 
 //average insertion and deletion time
 double measureInsertDeleteTime(size_t count, size_t trials) {
-	BinaryTree tree;
+	BinaryTree<int> tree;
 	fillTreeWithUniqueRandomNumbers(tree, count);
 
 	double total_insert_time = 0;
@@ -295,8 +745,10 @@ double measureInsertDeleteTime(size_t count, size_t trials) {
 
 //--------------------------------------------------------------------------------------------
 
+//query_server.cpp includes this file without main
+#ifndef AISD_NO_MAIN
 int main() {
-	BinaryTree tree;
+	BinaryTree<int> tree;
 	tree.insert(30);
 	tree.insert(20);
 	tree.insert(50);
@@ -322,7 +774,7 @@ int main() {
 	*/ 
 
 	//test assignment operator
-	BinaryTree tree1 = tree;
+	BinaryTree<int> tree1 = tree;
 
 	//print tree and copy of tree
 	tree.print(); // 9 14 15 16 20 30 45 47 50 80 84
@@ -346,6 +798,39 @@ int main() {
 	tree.erase(45);
 	tree.print(); // 9 14 15 16 20 30 47 50 80 84
 
+	//test other key types and orderings
+	BinaryTree<string> names;
+	names.insert("delta");
+	names.insert("alpha");
+	names.insert("charlie");
+	names.print(); // alpha charlie delta
+
+	BinaryTree<long long, greater<long long>> ids;
+	ids.insert(10000000000LL);
+	ids.insert(20000000000LL);
+	ids.insert(30000000000LL);
+	ids.print(); // 30000000000 20000000000 10000000000
+
+	//test set operations
+	BinaryTree<int> evens, odds;
+	for (int i = 0; i < 10; ++i) {
+		evens.insert(2 * i);
+		odds.insert(2 * i + 1);
+	}
+
+	BinaryTree<int> all = evens;
+	all.union_with(odds);
+	all.print(); // 0 1 2 ... 19
+
+	BinaryTree<int> high = all.split(9);
+	high.print(); // 10 11 ... 19
+
+	high.intersect_with(evens);
+	high.print(); // 10 12 14 16 18
+
+	all.difference(odds);
+	all.print(); // 0 2 4 6 8
+
 	//---------------------------------------------------------------------
 
 	//test the task
@@ -370,7 +855,7 @@ int main() {
 	cout << "Average fill time for 10000 unique numbers: " << measureFillTime(10000, 100) << " ms" << endl; 
 	cout << "Average fill time for 100000 unique numbers: " << measureFillTime(100000, 100) << " ms\n" << endl; 
 
-	BinaryTree tree1000, tree10000, tree100000; 
+	BinaryTree<int> tree1000, tree10000, tree100000; 
 	fillTreeWithUniqueRandomNumbers(tree1000, 1000); 
 	fillTreeWithUniqueRandomNumbers(tree10000, 10000); 
 	fillTreeWithUniqueRandomNumbers(tree100000, 100000); 
@@ -379,11 +864,25 @@ int main() {
 	cout << "Average search time in 10000 elements: " << measureSearchTime(tree10000, 1000) << " ms" << endl; 
 	cout << "Average search time in 100000 elements: " << measureSearchTime(tree100000, 1000) << " ms\n" << endl; 
 
+	tree100000.enableFilter(tree100000.size(), 0.01);
+	cout << "Average search time in 100000 elements with bloom filter: " << measureSearchTime(tree100000, 1000) << " ms" << endl;
+	cout << "Filter memory: " << tree100000.filter()->memory_bytes() << " bytes, expected false positive rate: "
+		<< tree100000.filter()->false_positive_rate() << "\n" << endl;
+
+	//the keys come from a dense universe, so a compressed bitmap holds them in a fraction of the tree's memory
+	RoaringSet keys100000;
+	fillTreeWithUniqueRandomNumbers(keys100000, 100000);
+	keys100000.run_optimize();
+	cout << "Average fill time for 100000 numbers in a roaring set: " << measureFillTime<RoaringSet>(100000, 100) << " ms" << endl;
+	cout << "Average search time in a roaring set of 100000 numbers: " << measureSearchTime(keys100000, 1000) << " ms" << endl;
+	cout << "Roaring set memory: " << keys100000.memory_bytes() << " bytes for " << keys100000.size() << " keys\n" << endl;
+
 	cout << "Average insert and delete time for 1000 elements: " << measureInsertDeleteTime(1000, 1000) << " ms" << endl; 
 	cout << "Average insert and delete time for 10000 elements: " << measureInsertDeleteTime(10000, 1000) << " ms" << endl; 
 	cout << "Average insert and delete time for 100000 elements: " << measureInsertDeleteTime(100000, 1000) << " ms\n" << endl; 
 
 	return 0;
 }
+#endif
 
 
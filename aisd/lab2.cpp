@@ -14,60 +14,486 @@
 //Сделать класс хэш - таблиц шаблонным, с возможностью работы с любым типом внутреннего контейнера, 
 //например, типом из стандартной библиотеки и самописным классом. (Для метода цепочек)
 #include <iostream>
+#include <algorithm>
+#include <array>
 #include <random>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "bloom_filter.h"
+#include "roaring_set.h"
+#include "perfect_hash.h"
 
 using namespace std;
 
+//Самописный контейнер для корзины: первые N элементов хранятся прямо в корзине,
+//при переполнении все элементы переносятся в динамический массив
+template<typename T, size_t N>
+class SmallVector {
+	alignas(T) unsigned char buffer[N * sizeof(T)];
+	T* heap;
+	uint32_t count;
+	uint32_t cap;
+
+	T* items() {
+		return heap ? heap : reinterpret_cast<T*>(buffer);
+	}
+
+	const T* items() const {
+		return heap ? heap : reinterpret_cast<const T*>(buffer);
+	}
+
+	void grow() {
+		uint32_t new_cap = cap * 2;
+		T* new_items = static_cast<T*>(::operator new(new_cap * sizeof(T)));
+
+		for (uint32_t i = 0; i < count; ++i) {
+			new (new_items + i) T(std::move(items()[i]));
+			items()[i].~T();
+		}
+		if (heap) {
+			::operator delete(heap);
+		}
+		heap = new_items;
+		cap = new_cap;
+	}
+
+public:
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	SmallVector() : heap(nullptr), count(0), cap(N) {}
+
+	SmallVector(const SmallVector& other) : SmallVector() {
+		for (const T& item : other) {
+			emplace_back(item);
+		}
+	}
+
+	SmallVector& operator=(const SmallVector& other) {
+		if (this != &other) {
+			clear();
+			for (const T& item : other) {
+				emplace_back(item);
+			}
+		}
+		return *this;
+	}
+
+	~SmallVector() {
+		clear();
+		if (heap) {
+			::operator delete(heap);
+		}
+	}
+
+	template<typename... Args>
+	T& emplace_back(Args&&... args) {
+		if (count == cap) {
+			grow();
+		}
+		T* item = new (items() + count) T(std::forward<Args>(args)...);
+		++count;
+		return *item;
+	}
+
+	iterator erase(iterator pos) {
+		iterator last = end() - 1;
+
+		for (iterator it = pos; it != last; ++it) {
+			*it = std::move(*(it + 1));
+		}
+		last->~T();
+		--count;
+		return pos;
+	}
+
+	void clear() {
+		for (uint32_t i = 0; i < count; ++i) {
+			items()[i].~T();
+		}
+		count = 0;
+	}
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	iterator begin() { return items(); }
+	iterator end() { return items() + count; }
+	const_iterator begin() const { return items(); }
+	const_iterator end() const { return items() + count; }
+};
+
+//Корзина с тремя элементами внутри: короткие цепочки не требуют выделений памяти
+template<typename T>
+using InlineBucket = SmallVector<T, 3>;
+
+//Полный хэш ключа до взятия по модулю. Целые ключи не хэшируются (метод деления),
+//строковые хэшируются через string_view, поэтому string, string_view и const char*
+//попадают в одну корзину
+template<typename Q>
+size_t full_hash(const Q& key) {
+	if constexpr (is_integral<Q>::value) {
+		return static_cast<size_t>(key);
+	}
+	else if constexpr (is_convertible<const Q&, string_view>::value) {
+		return std::hash<string_view>{}(key);
+	}
+	else {
+		return std::hash<Q>{}(key);
+	}
+}
+
+//Хэш-таблица только для чтения: минимальная совершенная хэш-функция отображает
+//n ключей на плоский массив из n записей без цепочек и деления по модулю,
+//поиск делает одно обращение к массиву
 template<typename K, typename V>
+class FrozenHashTable {
+	vector<pair<K, V>> slots;
+	PerfectHash index;
+
+public:
+	//ключи должны быть различны; построение идёт параллельно на threads потоках
+	explicit FrozenHashTable(vector<pair<K, V>> entries, size_t threads = thread::hardware_concurrency()) {
+		vector<uint64_t> hashes(entries.size());
+		for (size_t i = 0; i < entries.size(); ++i) {
+			hashes[i] = full_hash(entries[i].first);
+		}
+		index = PerfectHash(hashes, threads);
+
+		//order[slot] - номер записи, попавшей в slot
+		vector<size_t> order(entries.size());
+		for (size_t i = 0; i < entries.size(); ++i) {
+			order[index.slot(hashes[i])] = i;
+		}
+
+		slots.reserve(entries.size());
+		for (size_t i : order) {
+			slots.push_back(std::move(entries[i]));
+		}
+	}
+
+	//поиск элемента по ключу
+	template<typename Q>
+	const V* search(const Q& key) const {
+		if (slots.empty()) {
+			return nullptr;
+		}
+		const pair<K, V>& slot = slots[index.slot(full_hash(key))];
+		return slot.first == key ? &slot.second : nullptr;
+	}
+
+	size_t get_size() const {
+		return slots.size();
+	}
+
+	//объём массива записей и таблицы пилотов в байтах
+	size_t memory_bytes() const {
+		return slots.capacity() * sizeof(pair<K, V>) + index.memory_bytes();
+	}
+};
+
+//Политика вытеснения HashTable: NoEviction - обычная таблица, ClockEviction - режим кэша
+//с ограничениями и вытеснением по CLOCK. Без вытеснения записи не хранят места в кольце,
+//а поиск ничего не пишет
+struct NoEviction {};
+struct ClockEviction {};
+
+//Счётчики режима кэша
+struct CacheStats {
+	size_t hits = 0;
+	size_t misses = 0;
+	size_t evictions = 0;
+};
+
+//Bucket - контейнер корзины: std::list, std::vector или InlineBucket; Eviction - политика вытеснения
+template<typename K, typename V, template<typename...> class Bucket = InlineBucket, typename Eviction = NoEviction>
 class HashTable {
-	struct Node {
-		Node* next;
+	static constexpr bool evicting = is_same<Eviction, ClockEviction>::value;
+
+	//Запись ещё не попала в кольцо CLOCK (и пустое кольцо или список свободных мест)
+	static constexpr size_t unlinked = SIZE_MAX;
+
+	//место записи в кольце CLOCK, только в режиме кэша
+	struct ClockLink {
+		size_t slot = unlinked;
+	};
+
+	struct NoLink {};
+
+	struct Entry : conditional_t<evicting, ClockLink, NoLink> {
 		K key;
 		V value;
 
-		Node() : next(nullptr), key(), value() {}
-		Node(K key, V val) : next(nullptr), key(key), value(val) {}
+		template<typename KeyArg, typename... Args, typename = enable_if_t<!is_same<decay_t<KeyArg>, Entry>::value>>
+		Entry(KeyArg&& k, Args&&... args) : key(std::forward<KeyArg>(k)), value(std::forward<Args>(args)...) {}
 	};
 
-	Node** data;
+	Bucket<Entry>* data;
 	size_t size;
 	size_t capacity;
 
-	size_t hash(K key) {
-		return key % capacity;
+	//Статистика цепочек, обновляется при каждой вставке и удалении:
+	//chain_lengths[n] - число корзин длины n
+	vector<size_t> chain_lengths;
+	size_t collided = 0;
+	size_t max_chain = 0;
+
+	//Место в кольце CLOCK: корзина живой записи, соседи по кольцу и бит обращения.
+	//Свободные места связаны через next
+	struct Slot {
+		size_t bucket;
+		size_t prev;
+		size_t next;
+		bool referenced;
+	};
 
+	//Режим кэша: ограничения (0 - нет ограничения), кольцо CLOCK из живых записей, стрелка и счётчики
+	struct Cache {
+		size_t max_entries = 0;
+		size_t max_bytes = 0;
+		size_t bytes = 0;
+		vector<Slot> slots;
+		size_t free_slot = unlinked;
+		size_t hand = unlinked;
+		CacheStats stats;
+		function<void(const K&, V&)> on_evict;
+	} cache;
+
+	//Фильтр Блума перед корзинами: промах по ключу не читает цепочку
+	unique_ptr<BloomFilter> filter;
+
+	template<typename Q>
+	size_t hash(const Q& key) const {
+		return full_hash(key) % capacity;
 	}
 
-	void clear() {
+	void fill_filter() {
 		for (size_t i = 0; i < capacity; ++i) {
-			Node* cur = data[i];
+			for (const Entry& entry : data[i]) {
+				filter->add(full_hash(entry.key));
+			}
+		}
+	}
+
+	//Удалённые ключи остаются в фильтре, а новые могут превысить его размер;
+	//когда фильтр перестаёт соответствовать таблице, он заполняется заново
+	void refresh_filter() {
+		if (filter && filter->needs_rebuild(size)) {
+			filter->reset(size);
+			fill_filter();
+		}
+	}
+
+	template<typename Q>
+	void add_to_filter(const Q& key) {
+		if (filter) {
+			filter->add(full_hash(key));
+		}
+	}
+
+	//Корзина изменила длину с from на to (to = from ± 1)
+	void track_chain(size_t from, size_t to) {
+		if (to >= chain_lengths.size()) {
+			chain_lengths.resize(to + 1, 0);
+		}
+		--chain_lengths[from];
+		++chain_lengths[to];
+
+		collided += (to > 1) - (from > 1);
+		if (to > max_chain) {
+			max_chain = to;
+		}
+		else if (from == max_chain && chain_lengths[from] == 0) {
+			max_chain = to;
+		}
+	}
+
+	//Приблизительный объём записи: сама запись и содержимое строк
+	template<typename T>
+	static size_t heap_bytes(const T& x) {
+		if constexpr (is_same<T, string>::value) {
+			return x.size();
+		}
+		else {
+			return 0;
+		}
+	}
+
+	static size_t entry_bytes(const Entry& entry) {
+		return sizeof(Entry) + heap_bytes(entry.key) + heap_bytes(entry.value);
+	}
+
+	bool over_limit() const {
+		return (cache.max_entries && size > cache.max_entries) || (cache.max_bytes && cache.bytes > cache.max_bytes);
+	}
+
+	//Запись корзины с заданным местом в кольце; корзины переставляют записи
+	//при вставке и удалении, поэтому кольцо хранит номер корзины, а не указатель
+	typename Bucket<Entry>::iterator find_slot(Bucket<Entry>& bucket, size_t slot) {
+		auto it = bucket.begin();
+		while (it->slot != slot) {
+			++it;
+		}
+		return it;
+	}
+
+	//Новая запись корзины id встаёт в кольцо перед стрелкой и будет проверена последней
+	void link(size_t id) {
+		size_t slot = cache.free_slot;
 
-			while (cur) {
-				Node* tmpi = cur;
-				cur = cur->next;
-				delete tmpi;
+		if (slot != unlinked) {
+			cache.free_slot = cache.slots[slot].next;
+		}
+		else {
+			slot = cache.slots.size();
+			cache.slots.emplace_back();
+		}
+
+		Slot& added = cache.slots[slot];
+		added.bucket = id;
+		added.referenced = false;
+
+		if (cache.hand == unlinked) {
+			added.prev = added.next = cache.hand = slot;
+		}
+		else {
+			added.next = cache.hand;
+			added.prev = cache.slots[cache.hand].prev;
+			cache.slots[added.prev].next = slot;
+			cache.slots[cache.hand].prev = slot;
+		}
+		find_slot(data[id], unlinked)->slot = slot;
+	}
+
+	//Запись покидает кольцо, её место уходит в список свободных
+	void unlink(size_t slot) {
+		Slot& removed = cache.slots[slot];
+
+		if (removed.next == slot) {
+			cache.hand = unlinked;
+		}
+		else {
+			cache.slots[removed.prev].next = removed.next;
+			cache.slots[removed.next].prev = removed.prev;
+			if (cache.hand == slot) {
+				cache.hand = removed.next;
 			}
 		}
-		size = 0;
+		removed.next = cache.free_slot;
+		cache.free_slot = slot;
 	}
 
-public:
-	//Конструктор пустой хэш таблицы заданного размера
-	HashTable(size_t cap) : capacity(cap), size(0) {
-		data = new Node * [capacity];
+	//CLOCK: стрелка обходит кольцо живых записей, снимает бит обращения
+	//и вытесняет первую запись без него. Каждый снятый бит оплачен обращением,
+	//поэтому шаги стрелки амортизированно O(1); кроме них вытеснение
+	//просматривает одну корзину, как и поиск, который ему предшествует
+	void evict_one() {
+		for (;;) {
+			Slot& slot = cache.slots[cache.hand];
+			if (slot.referenced) {
+				slot.referenced = false;
+				cache.hand = slot.next;
+				continue;
+			}
 
-		for (size_t i = 0; i < capacity; ++i) {
-			data[i] = nullptr;
+			Bucket<Entry>& bucket = data[slot.bucket];
+			auto it = find_slot(bucket, cache.hand);
+
+			if (cache.on_evict) {
+				cache.on_evict(it->key, it->value);
+			}
+			cache.bytes -= entry_bytes(*it);
+			bucket.erase(it);
+			track_chain(bucket.size() + 1, bucket.size());
+			--size;
+			++cache.stats.evictions;
+			unlink(cache.hand);
+			return;
 		}
 	}
 
-	//Конструктор, заполняющий хэш таблицу случайными значениями согласно вашему заданию.
-	HashTable(size_t table_size, size_t count) : capacity(table_size) {
-		data = new Node * [capacity];
+	//Вытесняются только записи кольца: новая запись ещё не связана и не может
+	//вытеснить сама себя (она остаётся, даже если одна превышает max_bytes)
+	void enforce_limits() {
+		while (cache.hand != unlinked && over_limit()) {
+			evict_one();
+		}
+		refresh_filter();
+	}
+
+	//Учёт записи, только что добавленной в конец корзины id
+	void inserted(size_t id) {
+		Bucket<Entry>& bucket = data[id];
+
+		track_chain(bucket.size() - 1, bucket.size());
+		cache.bytes += entry_bytes(*std::prev(bucket.end()));
+		++size;
+		if constexpr (evicting) {
+			enforce_limits();
+			link(id);
+		}
+		else {
+			refresh_filter();
+		}
+	}
+
+	void reset_chains() {
+		chain_lengths.assign(1, capacity);
+		collided = 0;
+		max_chain = 0;
+	}
+
+	//Поиск по любому ключу Q, сравнимому с K (гетерогенный поиск)
+	template<typename Q>
+	Entry* find(const Q& key) {
+		if (filter && !filter->may_contain(full_hash(key))) {
+			return nullptr;
+		}
+		for (Entry& entry : data[hash(key)]) {
+			if (entry.key == key) {
+				return &entry;
+			}
+		}
+		return nullptr;
+	}
 
+	void clear() {
 		for (size_t i = 0; i < capacity; ++i) {
-			data[i] = nullptr;
+			data[i].clear();
+		}
+		size = 0;
+		cache.bytes = 0;
+		cache.slots.clear();
+		cache.free_slot = unlinked;
+		cache.hand = unlinked;
+		reset_chains();
+		if (filter) {
+			filter->clear();
 		}
+	}
+
+public:
+	//Конструктор пустой хэш таблицы заданного размера
+	HashTable(size_t cap) : capacity(cap), size(0) {
+		data = new Bucket<Entry>[capacity];
+		reset_chains();
+	}
+
+	//Конструктор, заполняющий хэш таблицу случайными значениями согласно вашему заданию.
+	HashTable(size_t table_size, size_t count) : capacity(table_size), size(0) {
+		data = new Bucket<Entry>[capacity];
+		reset_chains();
 
 		random_device rd;
 		mt19937 gen(rd());
@@ -80,25 +506,18 @@ public:
 	}
 
 	//Конструктор копирования;
-	HashTable(const HashTable& other) : size(other.size), capacity(other.capacity) {
-		data = new Node * [capacity];
+	HashTable(const HashTable& other) : size(other.size), capacity(other.capacity),
+		chain_lengths(other.chain_lengths), collided(other.collided), max_chain(other.max_chain), cache(other.cache),
+		filter(other.filter ? make_unique<BloomFilter>(*other.filter) : nullptr) {
+		data = new Bucket<Entry>[capacity];
 
 		for (size_t i = 0; i < capacity; ++i) {
-			data[i] = nullptr;
-			Node* source = other.data[i];
-			Node** dest = &data[i];
-
-			while (source) {
-				*dest = new Node(source->key, source->value);
-				dest = &((*dest)->next);
-				source = source->next;
-			}
+			data[i] = other.data[i];
 		}
 	}
 
 	//Деструктор;
 	~HashTable() {
-		clear();
 		delete[] data;
 	}
 	
@@ -106,22 +525,19 @@ public:
 	//Оператор присваивания;
 	HashTable& operator=(const HashTable& other) {
 		if (this != &other) {
-			clear();
 			delete[] data;
 
 			capacity = other.capacity;
 			size = other.size;
-			data = new Node * [capacity];
+			data = new Bucket<Entry>[capacity];
+			filter = other.filter ? make_unique<BloomFilter>(*other.filter) : nullptr;
+			chain_lengths = other.chain_lengths;
+			collided = other.collided;
+			max_chain = other.max_chain;
+			cache = other.cache;
 
 			for (size_t i = 0; i < capacity; ++i) {
-				data[i] = nullptr;
-				Node* source = other.data[i];
-				Node** dest = &data[i];
-				while (source) {
-					*dest = new Node(source->key, source->value);
-					dest = &((*dest)->next);
-					source = source->next;
-				}
+				data[i] = other.data[i];
 			}
 		}
 		return *this;
@@ -130,129 +546,207 @@ public:
 	//печать содержимого;
 	void print() {
 		for (size_t i = 0; i < capacity; ++i) {
-			Node* cur = data[i];
-			if (!cur) {
+			if (data[i].empty()) {
 				cout << "null" << endl;
 				continue;
 			}
 
-			size_t id = hash(cur->key);
-
 			cout << i << ": ";
-			while (cur) {
-				cout << cur->key << ":" << cur->value << " -> ";
-				cur = cur->next;
+			for (const Entry& entry : data[i]) {
+				cout << entry.key << ":" << entry.value << " -> ";
 			}
 			cout << "null" << endl;
 		}
 	}
 
-	//вставка значения по ключу;
-	bool insert(K key, const V& value) {
-		size_t id = hash(key);
-		Node** cur = &data[id];
+	//вставка значения по ключу; временные ключ и значение перемещаются, а не копируются
+	template<typename KeyArg, typename ValueArg>
+	bool insert(KeyArg&& key, ValueArg&& value) {
+		return try_emplace(std::forward<KeyArg>(key), std::forward<ValueArg>(value));
+	}
+
+	//вставка элемента, построенного из аргументов; при существующем ключе элемент уничтожается
+	template<typename... Args>
+	bool emplace(Args&&... args) {
+		Entry entry(std::forward<Args>(args)...);
 
-		while (*cur) {
-			if ((*cur)->key == key)
-				return false;
-			cur = &((*cur)->next);
+		if (find(entry.key)) {
+			return false;
 		}
 
-		*cur = new Node(key, value);
-		++size;
+		size_t id = hash(entry.key);
+		add_to_filter(entry.key);
+		data[id].emplace_back(std::move(entry));
+		inserted(id);
 		return true;
 	}
 
-	//вставка или присвоение значения по ключу.
-	void insert_or_assign(K key, V& value) {
+	//вставка с построением значения из аргументов на месте, только если ключа нет
+	template<typename KeyArg, typename... Args>
+	bool try_emplace(KeyArg&& key, Args&&... args) {
+		if (find(key)) {
+			return false;
+		}
+
 		size_t id = hash(key);
-		Node** cur = &data[id];
+		add_to_filter(key);
+		data[id].emplace_back(std::forward<KeyArg>(key), std::forward<Args>(args)...);
+		inserted(id);
+		return true;
+	}
 
-		while (*cur) {
-			if ((*cur)->key == key) {
-				(*cur)->value == value;
-				return;
+	//вставка или присвоение значения по ключу.
+	template<typename KeyArg, typename ValueArg>
+	void insert_or_assign(KeyArg&& key, ValueArg&& value) {
+		Entry* entry = find(key);
+
+		if (entry) {
+			cache.bytes -= entry_bytes(*entry);
+			entry->value = std::forward<ValueArg>(value);
+			cache.bytes += entry_bytes(*entry);
+			if constexpr (evicting) {
+				cache.slots[entry->slot].referenced = true;
+				enforce_limits();
 			}
-			cur = &((*cur)->next);
+			return;
 		}
 
-		*cur = new Node(key, value);
-		++size;
+		size_t id = hash(key);
+		add_to_filter(key);
+		data[id].emplace_back(std::forward<KeyArg>(key), std::forward<ValueArg>(value));
+		inserted(id);
 	}
 
 	//проверка наличия элемента по значению;
-	bool contains(V& value) {
+	bool contains(const V& value) {
 		for (size_t i = 0; i < capacity; ++i) {
-			Node* cur = data[i];
-
-			while (cur) {
-				if (cur->value == value) {
+			for (const Entry& entry : data[i]) {
+				if (entry.value == value) {
 					return true;
 				}
-				cur = cur->next;
 			}
 		}
 		return false;
 	}
 
-	//поиск элемента по ключу;
-	V* search(K key) {
-		size_t id = hash(key);
-		Node* cur = data[id];
+	//поиск элемента по ключу; в режиме кэша отмечает обращение к записи
+	template<typename Q>
+	V* search(const Q& key) {
+		Entry* entry = find(key);
 
-		while (cur) {
-			if (cur->key == key) {
-				return &(cur->value);
+		if constexpr (evicting) {
+			if (!entry) {
+				++cache.stats.misses;
+				return nullptr;
 			}
-			cur = cur->next;
+			++cache.stats.hits;
+			cache.slots[entry->slot].referenced = true;
 		}
-		return nullptr;
+		return entry ? &entry->value : nullptr;
 	}
 
 	//удаление элемента по ключу;
-	bool erase(K key) {
-		size_t id = hash(key);
-		Node** cur = data[id];
-
-		while (*cur) {
-			if ((*cur)->key == key) {
-				Node* to_delete = *cur;
-				*cur = (*cur)->next;
-				delete to_delete;
+	template<typename Q>
+	bool erase(const Q& key) {
+		Bucket<Entry>& bucket = data[hash(key)];
+
+		for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+			if (it->key == key) {
+				if constexpr (evicting) {
+					unlink(it->slot);
+				}
+				cache.bytes -= entry_bytes(*it);
+				bucket.erase(it);
+				track_chain(bucket.size() + 1, bucket.size());
 				--size;
+				refresh_filter();
 				return true;
 			}
-			cur = &((*cur)->next);
 		}
 		return false;
 	}
 
 	//возвращает количество элементов, у которых значение хэш - функции совпадает с переданным.
-	int count(K key) {
-		size_t id = hash(key);
-		size_t count = 0;
-		Node* cur = data[id];
+	template<typename Q>
+	int count(const Q& key) {
+		return data[hash(key)].size();
+	}
+
+	//копия текущих ключей в таблицу только для чтения с одним обращением на поиск
+	FrozenHashTable<K, V> freeze(size_t threads = thread::hardware_concurrency()) const {
+		vector<pair<K, V>> entries;
+		entries.reserve(size);
 
-		while (cur) {
-			++count;
-			cur = cur->next;
+		for (size_t i = 0; i < capacity; ++i) {
+			for (const Entry& entry : data[i]) {
+				entries.emplace_back(entry.key, entry.value);
+			}
 		}
-		return count;
+		return FrozenHashTable<K, V>(std::move(entries), threads);
+	}
+
+	//режим кэша: не больше max_entries записей и max_bytes байт (0 - без ограничения);
+	//лишние записи вытесняются по CLOCK за амортизированное O(1) плюс просмотр корзины
+	void set_cache_limits(size_t max_entries, size_t max_bytes = 0) {
+		static_assert(evicting, "cache mode requires the ClockEviction policy");
+		cache.max_entries = max_entries;
+		cache.max_bytes = max_bytes;
+		enforce_limits();
+	}
+
+	//вызывается для каждой вытесненной записи перед её удалением
+	void set_evict_callback(function<void(const K&, V&)> callback) {
+		static_assert(evicting, "cache mode requires the ClockEviction policy");
+		cache.on_evict = std::move(callback);
+	}
+
+	const CacheStats& cache_stats() const {
+		static_assert(evicting, "cache mode requires the ClockEviction policy");
+		return cache.stats;
+	}
+
+	//приблизительный объём записей в байтах
+	size_t memory_used() const {
+		return cache.bytes;
+	}
+
+	//включает фильтр Блума перед поиском, рассчитанный на expected_keys ключей
+	void enable_filter(size_t expected_keys, double false_positive_rate) {
+		filter = make_unique<BloomFilter>(expected_keys, false_positive_rate);
+		if (filter->needs_rebuild(size)) {
+			filter->reset(size);
+		}
+		fill_filter();
+	}
+
+	void disable_filter() {
+		filter.reset();
+	}
+
+	//статистика фильтра (память, ожидаемая доля ложных срабатываний) или nullptr
+	const BloomFilter* get_filter() const {
+		return filter.get();
 	}
 
 	// Количество коллизий (корзин с более чем 1 элементом)
 	size_t collisions_count() const {
-		size_t collision = 0;
-		for (size_t i = 0; i < capacity; ++i) {
-			if (data[i] && data[i]->next) {
-				++collision;
-			}
-		}
-		return collision;
+		return collided;
+	}
+
+	//длина самой длинной цепочки
+	size_t max_chain_length() const {
+		return max_chain;
+	}
+
+	//гистограмма длин цепочек: [n] - число корзин с n элементами
+	const vector<size_t>& chain_histogram() const {
+		return chain_lengths;
 	}
 };
 
-void analyze_collisions(size_t group_size) {
+//Анализ коллизий и замер времени заполнения и поиска для заданного контейнера корзин
+template<template<typename...> class Bucket>
+void analyze_collisions(size_t group_size, const char* bucket_name) {
 	size_t experiments = 100;
 	const size_t num_sizes = 10;
 	size_t table_sizes[num_sizes] = { 25, 75, 125, 175, 225, 275, 325, 375, 425, 475 };
@@ -262,42 +756,52 @@ void analyze_collisions(size_t group_size) {
 	uniform_int_distribution<int> key_dist(0, 10000);
 	uniform_int_distribution<int> val_dist(0, 100);
 
-	cout << "Analyze collisions from group for " << group_size << " elements\n";
-	cout << "Table size | Average collisions | Collisions probability \n";
-	cout << "---------------------------------------------------------\n";
+	cout << "Analyze collisions from group for " << group_size << " elements, buckets: " << bucket_name << "\n";
+	cout << "Table size | Average collisions | Collisions probability | Average max chain | Fill and search time, us\n";
+	cout << "-----------------------------------------------------------------------------------------------------\n";
 
 	for (size_t i = 0; i < num_sizes; ++i) {
 		size_t table_size = table_sizes[i];
 		size_t total_collisions = 0;
+		size_t total_max_chain = 0;
+		double total_time = 0;
 
 		for (size_t i = 0; i < experiments; ++i) {
-			HashTable<int, int> ht(table_size);
+			// Генерация уникальных ключей: десяток ключей хранится в коротком массиве вместо 10 КБ флагов
+			RoaringSet used_keys;
+			vector<int> keys;
 
-			// Генерация уникальных ключей
-			bool* used_keys = new bool[10001]();
-			size_t inserted = 0;
-
-			while (inserted < group_size) {
+			while (keys.size() < group_size) {
 				int key = key_dist(gen);
 
-				if (!used_keys[key]) {
-					used_keys[key] = true;
-					ht.insert(key, val_dist(gen));
-					inserted++;
+				if (used_keys.insert(key)) {
+					keys.push_back(key);
 				}
 			}
-			delete[] used_keys;
+
+			auto start = chrono::high_resolution_clock::now();
+			HashTable<int, int, Bucket> ht(table_size);
+
+			for (int key : keys) {
+				ht.insert(key, val_dist(gen));
+			}
+			for (int key : keys) {
+				ht.search(key);
+			}
+			auto end = chrono::high_resolution_clock::now();
+			total_time += chrono::duration<double, micro>(end - start).count();
 
 			if (ht.collisions_count() > 0) {
 				++total_collisions;
 			}
+			total_max_chain += ht.max_chain_length();
 		}
 
 		double avg_collisions = (double)total_collisions / experiments;
 		double collision_prob = (avg_collisions) * 100;
 
-		printf("%-10zu | %-18.2f | %-18.2f%%\n",
-			table_size, avg_collisions, collision_prob);
+		printf("%-10zu | %-18.2f | %-21.2f%% | %-17.2f | %-.2f\n",
+			table_size, avg_collisions, collision_prob, (double)total_max_chain / experiments, total_time / experiments);
 
 		//if (collision_prob < 50.0) {
 		//	cout << "\nBest table sizes: " << table_size
@@ -311,6 +815,8 @@ void analyze_collisions(size_t group_size) {
 	}
 }
 
+//Сервер запросов (query_server.cpp) подключает этот файл без main
+#ifndef AISD_NO_MAIN
 int main() {
 	HashTable<int, string> ht(4);
 	ht.insert(1, "One");
@@ -323,10 +829,65 @@ int main() {
 
 	HashTable<int, string> ht2(ht);
 	ht2.print();
+
+	//обновление значения и поиск строкового ключа без построения string
+	string eleven = "Eleven (updated)";
+	ht.insert_or_assign(11, std::move(eleven));
+	cout << "11 -> " << *ht.search(11) << endl;
+
+	HashTable<string, int> words(8);
+	words.try_emplace("one", 1);
+	words.emplace("two", 2);
+	string_view probe = "two";
+	cout << "two -> " << *words.search(probe) << endl;
+
+	//промахи отсекаются фильтром до обхода цепочки
+	HashTable<int, int> numbers(1024);
+	for (int i = 0; i < 10000; i += 2) {
+		numbers.insert(i, i);
+	}
+	numbers.enable_filter(5000, 0.01);
+	size_t false_positives = 0;
+	for (int i = 1; i < 10000; i += 2) {
+		if (numbers.get_filter()->may_contain(i)) {
+			++false_positives;
+		}
+	}
+	cout << "Filter memory: " << numbers.get_filter()->memory_bytes() << " bytes, false positives: "
+		<< false_positives << " of 5000 misses" << endl;
+
+	//после заполнения таблица только читается: замораживаем её в совершенный хэш
+	FrozenHashTable<int, int> frozen = numbers.freeze();
+	cout << "Frozen table: " << frozen.get_size() << " keys, " << frozen.memory_bytes() << " bytes, 4 -> "
+		<< *frozen.search(4) << ", 5 found: " << (frozen.search(5) != nullptr) << endl;
+
+	//набор ключей, известный при компиляции, хэшируется при компиляции
+	constexpr array<int, 6> codes = { 101, 205, 307, 411, 503, 619 };
+	constexpr StaticPerfectHash<int, 6> code_index(codes);
+	static_assert(code_index.contains(307) && !code_index.contains(308), "static perfect hash");
+	cout << "Code 411 -> slot " << code_index.find(411) << endl;
+
+	//кэш на 100 записей перед медленным хранилищем: горячие ключи 0-49 не вытесняются
+	HashTable<int, int, InlineBucket, ClockEviction> recent(64);
+	size_t written_back = 0;
+	recent.set_cache_limits(100);
+	recent.set_evict_callback([&](const int&, int&) { ++written_back; });
+	for (int i = 0; i < 10000; ++i) {
+		int key = i % 2 ? i % 50 : 50 + i;
+		if (!recent.search(key)) {
+			recent.insert(key, key);
+		}
+	}
+	const CacheStats& stats = recent.cache_stats();
+	cout << "Cache hits: " << stats.hits << ", misses: " << stats.misses << ", evictions: " << stats.evictions
+		<< ", written back: " << written_back << ", memory: " << recent.memory_used() << " bytes" << endl;
 	//for (size_t i = 0; i < 1001; i += 100) {
 	//	analyze_collisions(i);
 	//}
 
-	analyze_collisions(23);
+	analyze_collisions<InlineBucket>(23, "inline small vector");
+	analyze_collisions<list>(23, "std::list");
+	analyze_collisions<vector>(23, "std::vector");
 	return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -5,9 +5,13 @@
 //максимальна).Напишите функцию, которая находит такой травмпункт.
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iterator>
 #include <iostream>
 #include <functional>
+#include <future>
+#include <iomanip>
 #include <memory>
 #include <map>
 #include <numeric>
@@ -18,6 +22,7 @@
 #include <queue>
 #include <limits>
 #include <stdexcept>
+#include <thread>
 
 template<typename Vertex, typename Distance = double>
 class Graph {
@@ -35,46 +40,272 @@ public:
     };
 
 private:
+    // Удаленные вершины помечаются в alive и вычищаются одним проходом compact()
     std::vector<Vertex> vertices;
-    std::multimap<Vertex, Edge> edges;
+    std::vector<bool> alive;
+    std::map<Vertex, size_t> positions;
+    size_t tombstones = 0;
+
+    // Ребро хранится дважды: по начальной вершине в edges и по конечной в incoming.
+    // Каждая копия знает итератор своего двойника (итераторы multimap стабильны),
+    // поэтому удаление ребра не ищет его среди ребер соседа
+    struct Link;
+    using Links = std::multimap<Vertex, Link>;
+
+    struct Link : Edge {
+        typename Links::iterator twin;
+
+        explicit Link(const Edge& e) : Edge(e) {}
+    };
+
+    Links edges;
+    Links incoming; // ребра по конечной вершине
+
+    // Агрегаты исходящих ребер вершины, поддерживаются при изменении графа
+    struct EdgeAggregate {
+        size_t count = 0;
+        Distance sum{};
+
+        Distance average() const {
+            return count ? sum / static_cast<Distance>(count) : Distance{};
+        }
+    };
+
+    // Порядок по убыванию средней длины ребер, при равенстве - по вершине
+    struct ByAverage {
+        bool operator()(const std::pair<Distance, Vertex>& a, const std::pair<Distance, Vertex>& b) const {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        }
+    };
+
+    std::map<Vertex, EdgeAggregate> aggregates;
+    std::set<std::pair<Distance, Vertex>, ByAverage> by_average;
+
+    void update_aggregate(const Vertex& v, const Distance& d, bool added) {
+        EdgeAggregate& aggregate = aggregates[v];
+        by_average.erase({ aggregate.average(), v });
+
+        if (added) {
+            ++aggregate.count;
+            aggregate.sum += d;
+        }
+        else if (--aggregate.count == 0) {
+            aggregate.sum = Distance{};
+        }
+        else {
+            aggregate.sum -= d;
+        }
+        by_average.insert({ aggregate.average(), v });
+    }
+
+    void insert_edge(const Edge& e) {
+        auto out = edges.insert({ e.from, Link(e) });
+        auto in = incoming.insert({ e.to, Link(e) });
+        out->second.twin = in;
+        in->second.twin = out;
+    }
+
+    // Удаление ребра из edges вместе с его двойником из incoming
+    typename Links::iterator erase_edge(typename Links::iterator it) {
+        update_aggregate(it->second.from, it->second.distance, false);
+        incoming.erase(it->second.twin);
+        return edges.erase(it);
+    }
+
+    // Удаление вершины и ее ребер за O(степени), без уплотнения массива вершин
+    bool erase_vertex(const Vertex& v) {
+        auto position = positions.find(v);
+        if (position == positions.end()) {
+            return false;
+        }
+        alive[position->second] = false;
+        positions.erase(position);
+        ++tombstones;
+
+        auto in_range = incoming.equal_range(v);
+        for (auto i = in_range.first; i != in_range.second; ++i) {
+            if (i->second.from != v) {
+                update_aggregate(i->second.from, i->second.distance, false);
+                edges.erase(i->second.twin);
+            }
+        }
+        incoming.erase(in_range.first, in_range.second);
+
+        auto out_range = edges.equal_range(v);
+        for (auto it = out_range.first; it != out_range.second; ++it) {
+            if (it->second.to != v) {
+                incoming.erase(it->second.twin);
+            }
+        }
+        edges.erase(out_range.first, out_range.second);
+
+        by_average.erase({ aggregates[v].average(), v });
+        aggregates.erase(v);
+        return true;
+    }
+
+    using QueueItem = std::pair<Distance, Vertex>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    std::map<Vertex, Distance> dijkstra(const Vertex& source, bool reverse) const {
+        std::map<Vertex, Distance> distances;
+
+        if (!has_vertex(source)) {
+            return distances;
+        }
+
+        Queue queue;
+        distances[source] = Distance{};
+        queue.push({ Distance{}, source });
+
+        while (!queue.empty()) {
+            auto [dist, cur] = queue.top();
+            queue.pop();
+
+            if (dist != distances[cur]) {
+                continue;
+            }
+
+            auto relax = [&](const Vertex& next, const Distance& d) {
+                auto known = distances.find(next);
+                if (known == distances.end() || dist + d < known->second) {
+                    distances[next] = dist + d;
+                    queue.push({ dist + d, next });
+                }
+            };
+
+            if (reverse) {
+                for (const auto& edge : get_incoming_edges(cur)) {
+                    relax(edge.from, edge.distance);
+                }
+            }
+            else {
+                auto range = edges.equal_range(cur);
+                for (auto i = range.first; i != range.second; ++i) {
+                    relax(i->second.to, i->second.distance);
+                }
+            }
+        }
+        return distances;
+    }
+
+    static std::vector<Edge> trace_path(const std::map<Vertex, Edge>& parents, const Vertex& from, const Vertex& to) {
+        std::vector<Edge> path;
+
+        for (Vertex cur = to; cur != from; ) {
+            const Edge& edge = parents.at(cur);
+            path.push_back(edge);
+            cur = edge.from;
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // Ребра копии связываются заново: итераторы двойников должны указывать в свой граф
+    void copy_edges(const Graph& other) {
+        edges.clear();
+        incoming.clear();
+        for (const auto& [_, link] : other.edges) {
+            insert_edge(link);
+        }
+    }
 
 public:
+    Graph() = default;
+
+    Graph(const Graph& other)
+        : vertices(other.vertices), alive(other.alive), positions(other.positions), tombstones(other.tombstones),
+          aggregates(other.aggregates), by_average(other.by_average) {
+        copy_edges(other);
+    }
+
+    Graph(Graph&&) = default;
+
+    Graph& operator=(const Graph& other) {
+        if (this != &other) {
+            vertices = other.vertices;
+            alive = other.alive;
+            positions = other.positions;
+            tombstones = other.tombstones;
+            aggregates = other.aggregates;
+            by_average = other.by_average;
+            copy_edges(other);
+        }
+        return *this;
+    }
+
+    Graph& operator=(Graph&&) = default;
+
     // Проверка-добавление-удаление вершин
     bool has_vertex(const Vertex& v) const {
-        return std::find(vertices.begin(), vertices.end(), v) != vertices.end();
+        return positions.find(v) != positions.end();
     }
 
     bool add_vertex(const Vertex& v) {
         if (has_vertex(v)) {
             return false;
         }
+        positions[v] = vertices.size();
         vertices.push_back(v);
+        alive.push_back(true);
+        aggregates[v] = EdgeAggregate{};
+        by_average.insert({ Distance{}, v });
         return true;
     }
 
     bool remove_vertex(const Vertex& v) {
-        auto it = std::find(vertices.begin(), vertices.end(), v);
-        if (it == vertices.end()) {
+        if (!erase_vertex(v)) {
             return false;
         }
-        vertices.erase(it);
 
-        auto range = edges.equal_range(v);
-        edges.erase(range.first, range.second);
+        // Уплотнение, когда удаленных вершин больше, чем оставшихся
+        if (tombstones > vertices.size() - tombstones) {
+            compact();
+        }
+        return true;
+    }
+
+    // Пакетное удаление вершин с одним проходом уплотнения
+    size_t remove_vertices(const std::vector<Vertex>& vs) {
+        size_t removed = 0;
 
-        for (auto it = edges.begin(); it != edges.end(); ) {
-            if (it->second.to == v) {
-                it = edges.erase(it);
+        for (const auto& v : vs) {
+            if (erase_vertex(v)) {
+                ++removed;
             }
-            else {
-                ++it;
+        }
+        compact();
+        return removed;
+    }
+
+    // Удаление помеченных вершин из массива вершин
+    void compact() {
+        if (tombstones == 0) {
+            return;
+        }
+
+        size_t next = 0;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            if (alive[i]) {
+                positions[vertices[i]] = next;
+                vertices[next++] = std::move(vertices[i]);
             }
         }
-        return true;
+        vertices.resize(next);
+        alive.assign(next, true);
+        tombstones = 0;
     }
 
     std::vector<Vertex> get_vertices() const {
-        return vertices;
+        std::vector<Vertex> result;
+        result.reserve(order());
+
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            if (alive[i]) {
+                result.push_back(vertices[i]);
+            }
+        }
+        return result;
     }
 
     // Проверка-добавление-удаление ребер
@@ -82,15 +313,17 @@ public:
         if (!has_vertex(from) || !has_vertex(to)) {
             throw std::invalid_argument("One or both vertices don't exist");
         }
-        edges.insert({ from, Edge(from, to, d) });
+        insert_edge(Edge(from, to, d));
+        update_aggregate(from, d, true);
     }
 
     bool remove_edge(const Vertex& from, const Vertex& to) {
         bool removed = false;
+        auto range = edges.equal_range(from);
 
-        for (auto it = edges.begin(); it != edges.end(); ) {
-            if (it->first == from && it->second.to == to) {
-                it = edges.erase(it);
+        for (auto it = range.first; it != range.second; ) {
+            if (it->second.to == to) {
+                it = erase_edge(it);
                 removed = true;
             }
             else {
@@ -105,7 +338,7 @@ public:
 
         for (auto it = range.first; it != range.second; ++it) {
             if (it->second == e) {
-                edges.erase(it);
+                erase_edge(it);
                 return true;
             }
         }
@@ -135,7 +368,7 @@ public:
     }
 
     // Получение всех ребер, выходящих из вершины
-    std::vector<Edge> get_edges(const Vertex& vertex) {
+    std::vector<Edge> get_edges(const Vertex& vertex) const {
         std::vector<Edge> result;
         auto range = edges.equal_range(vertex);
 
@@ -145,21 +378,33 @@ public:
         return result;
     }
 
+    // Получение всех ребер, входящих в вершину
+    std::vector<Edge> get_incoming_edges(const Vertex& vertex) const {
+        std::vector<Edge> result;
+        auto range = incoming.equal_range(vertex);
+
+        for (auto i = range.first; i != range.second; ++i) {
+            result.push_back(i->second);
+        }
+        return result;
+    }
+
     size_t order() const {
-        return vertices.size();
+        return vertices.size() - tombstones;
     }
 
     size_t degree(const Vertex& v) const {
-        return edges.count(v);
+        auto it = aggregates.find(v);
+        return it == aggregates.end() ? 0 : it->second.count;
     }
 
     // Проверка сильной связности графа (в глубину)
     bool is_connected() const {
-        if (vertices.empty()) {
+        if (order() == 0) {
             return true;
         }
 
-        for (const auto& start : vertices) {
+        for (const auto& start : get_vertices()) {
             std::set<Vertex> visited;
             std::stack<Vertex> stack;
             stack.push(start);
@@ -179,7 +424,7 @@ public:
                     }
                 }
             }
-            if (visited.size() != vertices.size()) {
+            if (visited.size() != order()) {
                 return false;
             }
         }
@@ -192,18 +437,18 @@ public:
         std::map<Vertex, Edge> predecessors;
         const Distance infinity = std::numeric_limits<Distance>::max();
 
-        for (const auto& v : vertices) {
+        for (const auto& v : get_vertices()) {
             distances[v] = infinity;
         }
         distances[from] = Distance{};
 
         // Релаксация ребер
-        for (size_t i = 1; i < vertices.size(); ++i) {
+        for (size_t i = 1; i < order(); ++i) {
             for (const auto& [_, edge] : edges) {
                 if (distances[edge.from] != infinity &&
                     distances[edge.to] > distances[edge.from] + edge.distance) {
                     distances[edge.to] = distances[edge.from] + edge.distance;
-                    predecessors[edge.to] = edge;
+                    predecessors.insert_or_assign(edge.to, edge);
                 }
             }
         }
@@ -237,6 +482,142 @@ public:
         return path;
     }
 
+    // Расстояния от вершины до всех достижимых (Дейкстра, длины неотрицательны)
+    std::map<Vertex, Distance> distances_from(const Vertex& source) const {
+        return dijkstra(source, false);
+    }
+
+    // Расстояния от всех вершин, из которых достижима данная, до нее
+    std::map<Vertex, Distance> distances_to(const Vertex& target) const {
+        return dijkstra(target, true);
+    }
+
+    // Двунаправленный Дейкстра: поиск одновременно от начала и от конца пути
+    std::vector<Edge> shortest_path_bidirectional(const Vertex& from, const Vertex& to) const {
+        // Путь из вершины в неё саму пуст, как и в shortest_path
+        if (!has_vertex(from) || !has_vertex(to) || from == to) {
+            return {};
+        }
+
+        std::map<Vertex, Distance> forward_distances{ { from, Distance{} } };
+        std::map<Vertex, Distance> backward_distances{ { to, Distance{} } };
+        std::map<Vertex, Edge> forward_parents;
+        std::map<Vertex, Edge> backward_parents;
+        Queue forward_queue;
+        Queue backward_queue;
+
+        forward_queue.push({ Distance{}, from });
+        backward_queue.push({ Distance{}, to });
+
+        Distance best = std::numeric_limits<Distance>::max();
+        Vertex meeting = from;
+        bool found = false;
+
+        while (!forward_queue.empty() && !backward_queue.empty()) {
+            // Условие остановки: дальнейшие пути не короче найденного
+            if (found && forward_queue.top().first + backward_queue.top().first >= best) {
+                break;
+            }
+
+            bool forward = forward_queue.top().first <= backward_queue.top().first;
+            Queue& queue = forward ? forward_queue : backward_queue;
+            auto& own = forward ? forward_distances : backward_distances;
+            auto& other = forward ? backward_distances : forward_distances;
+            auto& parents = forward ? forward_parents : backward_parents;
+
+            auto [dist, cur] = queue.top();
+            queue.pop();
+
+            if (dist != own[cur]) {
+                continue;
+            }
+
+            auto relax = [&](const Edge& edge, const Vertex& next) {
+                Distance candidate = dist + edge.distance;
+                auto known = own.find(next);
+
+                if (known == own.end() || candidate < known->second) {
+                    own[next] = candidate;
+                    parents.insert_or_assign(next, edge);
+                    queue.push({ candidate, next });
+                }
+
+                auto met = other.find(next);
+                if (met != other.end() && own[next] + met->second < best) {
+                    best = own[next] + met->second;
+                    meeting = next;
+                    found = true;
+                }
+            };
+
+            if (forward) {
+                auto range = edges.equal_range(cur);
+                for (auto i = range.first; i != range.second; ++i) {
+                    relax(i->second, i->second.to);
+                }
+            }
+            else {
+                for (const auto& edge : get_incoming_edges(cur)) {
+                    relax(edge, edge.from);
+                }
+            }
+        }
+
+        if (!found) {
+            return {};
+        }
+
+        std::vector<Edge> path = trace_path(forward_parents, from, meeting);
+
+        for (Vertex cur = meeting; cur != to; ) {
+            const Edge& edge = backward_parents.at(cur);
+            path.push_back(edge);
+            cur = edge.to;
+        }
+        return path;
+    }
+
+    // A*: heuristic(v) - согласованная нижняя оценка расстояния от v до конечной вершины
+    template<typename Heuristic>
+    std::vector<Edge> shortest_path_astar(const Vertex& from, const Vertex& to, Heuristic heuristic) const {
+        if (!has_vertex(from) || !has_vertex(to)) {
+            return {};
+        }
+
+        std::map<Vertex, Distance> distances{ { from, Distance{} } };
+        std::map<Vertex, Edge> parents;
+        std::set<Vertex> settled;
+        Queue queue;
+
+        queue.push({ heuristic(from), from });
+
+        while (!queue.empty()) {
+            Vertex cur = queue.top().second;
+            queue.pop();
+
+            if (!settled.insert(cur).second) {
+                continue;
+            }
+            if (cur == to) {
+                return trace_path(parents, from, to);
+            }
+
+            auto range = edges.equal_range(cur);
+            for (auto i = range.first; i != range.second; ++i) {
+                const Edge& edge = i->second;
+                Distance candidate = distances[cur] + edge.distance;
+                auto known = distances.find(edge.to);
+
+                if (known == distances.end() || candidate < known->second) {
+                    distances[edge.to] = candidate;
+                    parents.insert_or_assign(edge.to, edge);
+                    queue.push({ candidate + heuristic(edge.to), edge.to });
+                }
+            }
+        }
+        return {};
+    }
+
     // Обход в ширину
     std::vector<Vertex> walk(const Vertex& start_vertex) const {
         std::vector<Vertex> visited;
@@ -271,58 +652,964 @@ public:
 
     // Вычисление средней длины ребер вершины
     Distance average_edge_length(const Vertex& v) const {
-        auto edges = const_cast<Graph*>(this)->get_edges(v);
-
-        if (edges.empty()) {
-            return Distance{};
-        }
+        auto it = aggregates.find(v);
+        return it == aggregates.end() ? Distance{} : it->second.average();
+    }
 
-        Distance sum = std::accumulate(edges.begin(), edges.end(), Distance{},
-            [](Distance acc, const Edge& e) { return acc + e.distance; });
+    // k вершин с наибольшей средней длиной ребер (самые удаленные от соседей)
+    std::vector<Vertex> most_isolated(size_t k) const {
+        std::vector<Vertex> result;
 
-        return sum / static_cast<Distance>(edges.size());
+        for (auto it = by_average.begin(); it != by_average.end() && result.size() < k; ++it) {
+            result.push_back(it->second);
+        }
+        return result;
     }
 };
 
+// Снимок графа с плотной нумерацией вершин 0..n-1 и списками смежности
+// в формате CSR (прямыми и обратными) для параллельных обходов.
 template<typename Vertex, typename Distance = double>
-Vertex find_vertex_with_max_avg_edge_length(const Graph<Vertex, Distance>& graph) {
-    if (graph.order() == 0) {
-        throw std::runtime_error("Graph is empty");
+class DenseGraph {
+public:
+    struct WalkResult {
+        std::vector<Vertex> visited;        // вершины по уровням обхода
+        std::vector<size_t> frontier_sizes; // размер каждого уровня
+    };
+
+private:
+    std::vector<Vertex> vertices;
+    std::map<Vertex, size_t> ids;
+    std::vector<size_t> out_offsets;
+    std::vector<size_t> out_targets;
+    std::vector<Distance> out_weights;
+    std::vector<size_t> in_offsets;
+    std::vector<size_t> in_sources;
+
+    // Параметры переключения направления обхода (Beamer et al.)
+    static constexpr size_t top_down_factor = 14;
+    static constexpr size_t bottom_up_factor = 24;
+    static constexpr size_t parallel_threshold = 4096;
+
+public:
+    // Выполнение body(thread, begin, end) над [0, count) в нескольких потоках,
+    // если элементов не меньше min_count
+    template<typename Body>
+    static void parallel_for(size_t count, size_t threads, Body body, size_t min_count = parallel_threshold) {
+        if (threads <= 1 || count < min_count) {
+            body(0, 0, count);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        size_t chunk = (count + threads - 1) / threads;
+
+        for (size_t t = 1; t < threads && t * chunk < count; ++t) {
+            workers.emplace_back(body, t, t * chunk, std::min(count, (t + 1) * chunk));
+        }
+        body(0, 0, std::min(count, chunk));
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
     }
 
-    Vertex result;
-    Distance max_avg = std::numeric_limits<Distance>::lowest();
+    explicit DenseGraph(const Graph<Vertex, Distance>& graph) : vertices(graph.get_vertices()) {
+        size_t n = vertices.size();
+
+        for (size_t i = 0; i < n; ++i) {
+            ids[vertices[i]] = i;
+        }
+
+        out_offsets.assign(n + 1, 0);
+        in_offsets.assign(n + 1, 0);
+
+        for (size_t i = 0; i < n; ++i) {
+            for (const auto& edge : graph.get_edges(vertices[i])) {
+                size_t to = ids.at(edge.to);
+                out_targets.push_back(to);
+                out_weights.push_back(edge.distance);
+                ++in_offsets[to + 1];
+            }
+            out_offsets[i + 1] = out_targets.size();
+        }
+
+        std::partial_sum(in_offsets.begin(), in_offsets.end(), in_offsets.begin());
+        in_sources.resize(out_targets.size());
 
-    for (const auto& vertex : graph.get_vertices()) {
-        Distance avg = graph.average_edge_length(vertex);
-        if (avg > max_avg) {
-            max_avg = avg;
-            result = vertex;
+        std::vector<size_t> fill(in_offsets.begin(), in_offsets.end() - 1);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t e = out_offsets[i]; e < out_offsets[i + 1]; ++e) {
+                in_sources[fill[out_targets[e]]++] = i;
+            }
         }
     }
-    return result;
-}
 
-int main() {
-    Graph<std::string, double> city_graph;
+    size_t order() const {
+        return vertices.size();
+    }
 
-    city_graph.add_vertex("Hospital A");
-    city_graph.add_vertex("Hospital B");
-    city_graph.add_vertex("Hospital C");
-    city_graph.add_vertex("Hospital D");
+    // Доступ к снимку по номерам вершин и ребер
+    bool has_vertex(const Vertex& v) const {
+        return ids.find(v) != ids.end();
+    }
 
-    city_graph.add_edge("Hospital A", "Hospital B", 5.0);
-    city_graph.add_edge("Hospital A", "Hospital C", 3.0);
-    city_graph.add_edge("Hospital B", "Hospital C", 2.0);
-    city_graph.add_edge("Hospital B", "Hospital D", 7.0);
-    city_graph.add_edge("Hospital C", "Hospital D", 1.0);
-    city_graph.add_edge("Hospital D", "Hospital A", 4.0);
+    size_t id(const Vertex& v) const {
+        return ids.at(v);
+    }
 
-    std::string furthest = find_vertex_with_max_avg_edge_length(city_graph);
-    std::cout << "The trauma center furthest from its neighbors is " << furthest << std::endl;
+    const Vertex& vertex(size_t id) const {
+        return vertices[id];
+    }
 
-    double avg = city_graph.average_edge_length(furthest);
-    std::cout << "Average distance to neighbors: " << avg << std::endl;
+    size_t edges_begin(size_t id) const {
+        return out_offsets[id];
+    }
+
+    size_t edges_end(size_t id) const {
+        return out_offsets[id + 1];
+    }
+
+    size_t target(size_t edge) const {
+        return out_targets[edge];
+    }
+
+    const Distance& weight(size_t edge) const {
+        return out_weights[edge];
+    }
+
+    // Параллельный поуровневый обход в ширину с переключением направления:
+    // сверху вниз (от фронта к соседям) или снизу вверх (непосещенные
+    // вершины ищут родителя во фронте). Множество посещенных вершин
+    // совпадает с Graph::walk, порядок внутри уровня может отличаться.
+    WalkResult walk(const Vertex& start_vertex, size_t threads = std::thread::hardware_concurrency()) const {
+        WalkResult result;
+        auto start = ids.find(start_vertex);
+
+        if (start == ids.end()) {
+            return result;
+        }
+
+        size_t n = vertices.size();
+        size_t words = (n + 63) / 64;
+        threads = std::max<size_t>(threads, 1);
+
+        std::unique_ptr<std::atomic<uint64_t>[]> visited(new std::atomic<uint64_t>[words]);
+        for (size_t i = 0; i < words; ++i) {
+            visited[i].store(0, std::memory_order_relaxed);
+        }
+
+        auto try_visit = [&](size_t v) {
+            uint64_t bit = uint64_t(1) << (v % 64);
+            return !(visited[v / 64].fetch_or(bit, std::memory_order_relaxed) & bit);
+        };
+
+        std::vector<size_t> frontier{ start->second };
+        std::vector<std::vector<size_t>> next(threads);
+        std::vector<uint64_t> frontier_bits(words);
+        size_t unexplored_edges = out_targets.size();
+        bool bottom_up = false;
+
+        try_visit(start->second);
+
+        while (!frontier.empty()) {
+            result.frontier_sizes.push_back(frontier.size());
+
+            size_t frontier_edges = 0;
+            for (size_t v : frontier) {
+                result.visited.push_back(vertices[v]);
+                frontier_edges += out_offsets[v + 1] - out_offsets[v];
+            }
+            unexplored_edges -= frontier_edges;
+
+            if (!bottom_up && frontier_edges > unexplored_edges / top_down_factor) {
+                bottom_up = true;
+            }
+            else if (bottom_up && frontier.size() < n / bottom_up_factor) {
+                bottom_up = false;
+            }
+
+            for (auto& local : next) {
+                local.clear();
+            }
+
+            if (bottom_up) {
+                std::fill(frontier_bits.begin(), frontier_bits.end(), 0);
+                for (size_t v : frontier) {
+                    frontier_bits[v / 64] |= uint64_t(1) << (v % 64);
+                }
+
+                // Диапазоны выровнены по 64, чтобы потоки писали в разные слова
+                parallel_for(words, threads, [&](size_t t, size_t begin, size_t end) {
+                    for (size_t v = begin * 64; v < std::min(n, end * 64); ++v) {
+                        uint64_t bit = uint64_t(1) << (v % 64);
+
+                        if (visited[v / 64].load(std::memory_order_relaxed) & bit) {
+                            continue;
+                        }
+
+                        for (size_t e = in_offsets[v]; e < in_offsets[v + 1]; ++e) {
+                            size_t u = in_sources[e];
+
+                            if (frontier_bits[u / 64] & (uint64_t(1) << (u % 64))) {
+                                visited[v / 64].fetch_or(bit, std::memory_order_relaxed);
+                                next[t].push_back(v);
+                                break;
+                            }
+                        }
+                    }
+                });
+            }
+            else {
+                parallel_for(frontier.size(), threads, [&](size_t t, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        size_t u = frontier[i];
+
+                        for (size_t e = out_offsets[u]; e < out_offsets[u + 1]; ++e) {
+                            if (try_visit(out_targets[e])) {
+                                next[t].push_back(out_targets[e]);
+                            }
+                        }
+                    }
+                });
+            }
+
+            frontier.clear();
+            for (const auto& local : next) {
+                frontier.insert(frontier.end(), local.begin(), local.end());
+            }
+        }
+        return result;
+    }
+};
+
+// Динамическое поддержание кратчайших путей от выбранных источников (Ramalingam-Reps).
+// Ребра графа меняются только через этот объект: изменение сразу применяется
+// ко всем деревьям кратчайших путей, и в каждом пересчитывается только затронутая часть.
+// Длины ребер должны быть неотрицательными.
+template<typename Vertex, typename Distance = double>
+class DynamicShortestPaths {
+public:
+    using Edge = typename Graph<Vertex, Distance>::Edge;
+
+private:
+    using QueueItem = std::pair<Distance, Vertex>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    // Метки и дерево кратчайших путей одного источника
+    struct Tree {
+        std::map<Vertex, Distance> distances;
+        std::map<Vertex, Edge> parents;
+
+        Distance distance(const Vertex& v) const {
+            auto it = distances.find(v);
+            return it == distances.end() ? std::numeric_limits<Distance>::max() : it->second;
+        }
+    };
+
+    Graph<Vertex, Distance>& graph;
+    std::map<Vertex, Tree> trees;
+    size_t affected = 0;
+
+    static void check_distance(const Distance& d) {
+        if (d < Distance{}) {
+            throw std::invalid_argument("Negative edge distance");
+        }
+    }
+
+    // Релаксация ребра; true, если метка конца ребра уменьшилась
+    static bool relax(Tree& tree, const Edge& edge, Queue& queue) {
+        Distance from_distance = tree.distance(edge.from);
+
+        if (from_distance == std::numeric_limits<Distance>::max()) {
+            return false;
+        }
+
+        Distance candidate = from_distance + edge.distance;
+
+        if (candidate < tree.distance(edge.to)) {
+            tree.distances[edge.to] = candidate;
+            tree.parents.insert_or_assign(edge.to, edge);
+            queue.push({ candidate, edge.to });
+            return true;
+        }
+        return false;
+    }
+
+    // Дейкстра от вершин в очереди: распространяет только уменьшение меток
+    void propagate(Tree& tree, Queue& queue) {
+        while (!queue.empty()) {
+            auto [dist, cur] = queue.top();
+            queue.pop();
+
+            if (dist != tree.distance(cur)) {
+                continue;
+            }
+            ++affected;
+
+            for (const auto& edge : graph.get_edges(cur)) {
+                relax(tree, edge, queue);
+            }
+        }
+    }
+
+    // Восстановление поддерева вершины после удаления ребра дерева путей
+    void repair(Tree& tree, const Vertex& root) {
+        std::vector<Vertex> subtree{ root };
+        std::set<Vertex> marked{ root };
+
+        for (size_t i = 0; i < subtree.size(); ++i) {
+            for (const auto& edge : graph.get_edges(subtree[i])) {
+                auto parent = tree.parents.find(edge.to);
+
+                if (parent != tree.parents.end() && parent->second.from == subtree[i] &&
+                    marked.insert(edge.to).second) {
+                    subtree.push_back(edge.to);
+                }
+            }
+        }
+
+        for (const auto& v : subtree) {
+            tree.distances.erase(v);
+            tree.parents.erase(v);
+        }
+
+        // Новые метки берутся только от незатронутых вершин
+        Queue queue;
+        for (const auto& v : subtree) {
+            for (const auto& edge : graph.get_incoming_edges(v)) {
+                relax(tree, edge, queue);
+            }
+        }
+        propagate(tree, queue);
+    }
+
+    const Tree& tree_of(const Vertex& source) const {
+        auto it = trees.find(source);
+        if (it == trees.end()) {
+            throw std::invalid_argument("Vertex is not a tracked source");
+        }
+        return it->second;
+    }
+
+    // Источник, ближайший к вершине, или trees.end(), если вершина недостижима
+    typename std::map<Vertex, Tree>::const_iterator nearest(const Vertex& v) const {
+        auto best = trees.end();
+        for (auto it = trees.begin(); it != trees.end(); ++it) {
+            if (it->second.distance(v) != std::numeric_limits<Distance>::max() &&
+                (best == trees.end() || it->second.distance(v) < best->second.distance(v))) {
+                best = it;
+            }
+        }
+        return best;
+    }
+
+public:
+    DynamicShortestPaths(Graph<Vertex, Distance>& g, const std::vector<Vertex>& sources) : graph(g) {
+        for (const auto& v : graph.get_vertices()) {
+            for (const auto& edge : graph.get_edges(v)) {
+                check_distance(edge.distance);
+            }
+        }
+
+        for (const auto& source : sources) {
+            add_source(source);
+        }
+    }
+
+    DynamicShortestPaths(Graph<Vertex, Distance>& g, const Vertex& source)
+        : DynamicShortestPaths(g, std::vector<Vertex>{ source }) {}
+
+    // Новый источник считается одной Дейкстрой; false, если он уже отслеживается
+    bool add_source(const Vertex& source) {
+        if (!graph.has_vertex(source)) {
+            throw std::invalid_argument("Source vertex doesn't exist");
+        }
+
+        auto [it, added] = trees.try_emplace(source);
+        if (!added) {
+            return false;
+        }
+        affected = 0;
+
+        Queue queue;
+        it->second.distances[source] = Distance{};
+        queue.push({ Distance{}, source });
+        propagate(it->second, queue);
+        return true;
+    }
+
+    bool remove_source(const Vertex& source) {
+        return trees.erase(source) > 0;
+    }
+
+    std::vector<Vertex> sources() const {
+        std::vector<Vertex> result;
+        for (const auto& [source, _] : trees) {
+            result.push_back(source);
+        }
+        return result;
+    }
+
+    // Расстояние от заданного источника
+    Distance distance(const Vertex& source, const Vertex& v) const {
+        return tree_of(source).distance(v);
+    }
+
+    // Расстояние от ближайшего источника
+    Distance distance(const Vertex& v) const {
+        auto best = nearest(v);
+        return best == trees.end() ? std::numeric_limits<Distance>::max() : best->second.distance(v);
+    }
+
+    // Количество вершин, пересчитанных во всех деревьях при последнем изменении
+    size_t affected_count() const {
+        return affected;
+    }
+
+    void add_edge(const Vertex& from, const Vertex& to, const Distance& d) {
+        check_distance(d);
+        graph.add_edge(from, to, d);
+        affected = 0;
+
+        for (auto& [_, tree] : trees) {
+            Queue queue;
+            if (relax(tree, Edge(from, to, d), queue)) {
+                propagate(tree, queue);
+            }
+        }
+    }
+
+    bool remove_edge(const Vertex& from, const Vertex& to) {
+        if (!graph.remove_edge(from, to)) {
+            return false;
+        }
+        affected = 0;
+
+        for (auto& [_, tree] : trees) {
+            auto parent = tree.parents.find(to);
+            if (parent != tree.parents.end() && parent->second.from == from) {
+                repair(tree, to);
+            }
+        }
+        return true;
+    }
+
+    bool remove_edge(const Edge& e) {
+        if (!graph.remove_edge(e)) {
+            return false;
+        }
+        affected = 0;
+
+        bool still_present = graph.has_edge(e);
+        for (auto& [_, tree] : trees) {
+            auto parent = tree.parents.find(e.to);
+            if (parent != tree.parents.end() && parent->second == e && !still_present) {
+                repair(tree, e.to);
+            }
+        }
+        return true;
+    }
+
+    // Кратчайший путь от заданного источника до вершины по текущим меткам
+    std::vector<Edge> shortest_path(const Vertex& source, const Vertex& to) const {
+        const Tree& tree = tree_of(source);
+        std::vector<Edge> path;
+
+        if (tree.distance(to) == std::numeric_limits<Distance>::max()) {
+            return path;
+        }
+
+        Vertex cur = to;
+        while (cur != source) {
+            const Edge& edge = tree.parents.at(cur);
+            path.push_back(edge);
+            cur = edge.from;
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // Кратчайший путь от ближайшего источника
+    std::vector<Edge> shortest_path(const Vertex& to) const {
+        auto best = nearest(to);
+        return best == trees.end() ? std::vector<Edge>{} : shortest_path(best->first, to);
+    }
+};
+
+// Индекс ориентиров (ALT) для A*: расстояния от ориентиров и до них.
+// По неравенству треугольника дает нижние оценки d(v, t). Оценки остаются
+// допустимыми при удалении и удлинении ребер, после добавления ребер
+// индекс нужно перестроить.
+template<typename Vertex, typename Distance = double>
+class LandmarkIndex {
+    std::vector<Vertex> landmarks;
+    std::map<Vertex, std::vector<Distance>> from_landmarks;
+    std::map<Vertex, std::vector<Distance>> to_landmarks;
+
+    static constexpr Distance infinity() {
+        return std::numeric_limits<Distance>::max();
+    }
+
+    template<typename T>
+    static void write_value(std::ostream& out, const T& value) {
+        out << value;
+    }
+
+    static void write_value(std::ostream& out, const std::string& value) {
+        out << std::quoted(value);
+    }
+
+    template<typename T>
+    static void read_value(std::istream& in, T& value) {
+        in >> value;
+    }
+
+    static void read_value(std::istream& in, std::string& value) {
+        in >> std::quoted(value);
+    }
+
+    void add_landmark(const Graph<Vertex, Distance>& graph, const Vertex& landmark) {
+        auto from = graph.distances_from(landmark);
+        auto to = graph.distances_to(landmark);
+
+        for (const auto& v : graph.get_vertices()) {
+            auto f = from.find(v);
+            auto t = to.find(v);
+            from_landmarks[v].push_back(f == from.end() ? infinity() : f->second);
+            to_landmarks[v].push_back(t == to.end() ? infinity() : t->second);
+        }
+        landmarks.push_back(landmark);
+    }
+
+public:
+    // Построение: ориентиры выбираются как самые удаленные от уже выбранных
+    static LandmarkIndex build(const Graph<Vertex, Distance>& graph, size_t count) {
+        LandmarkIndex index;
+        auto vertices = graph.get_vertices();
+
+        if (vertices.empty()) {
+            return index;
+        }
+
+        index.add_landmark(graph, vertices.front());
+
+        while (index.landmarks.size() < std::min(count, vertices.size())) {
+            const Vertex* farthest = nullptr;
+            Distance farthest_distance = Distance{};
+
+            for (const auto& v : vertices) {
+                const auto& known = index.from_landmarks[v];
+                Distance nearest = *std::min_element(known.begin(), known.end());
+
+                if (nearest > farthest_distance) {
+                    farthest_distance = nearest;
+                    farthest = &v;
+                }
+            }
+
+            if (!farthest) {
+                break;
+            }
+            index.add_landmark(graph, *farthest);
+        }
+        return index;
+    }
+
+    // Фоновое построение; граф не должен меняться до получения результата
+    static std::future<LandmarkIndex> build_async(const Graph<Vertex, Distance>& graph, size_t count) {
+        return std::async(std::launch::async, [&graph, count]() { return build(graph, count); });
+    }
+
+    size_t size() const {
+        return landmarks.size();
+    }
+
+    // Нижняя оценка расстояния от v до target
+    Distance lower_bound(const Vertex& v, const Vertex& target) const {
+        auto v_from = from_landmarks.find(v);
+        auto t_from = from_landmarks.find(target);
+
+        if (v_from == from_landmarks.end() || t_from == from_landmarks.end()) {
+            return Distance{};
+        }
+
+        const auto& v_to = to_landmarks.at(v);
+        const auto& t_to = to_landmarks.at(target);
+        Distance bound = Distance{};
+
+        for (size_t i = 0; i < landmarks.size(); ++i) {
+            // d(L, t) - d(L, v) <= d(v, t)
+            if (v_from->second[i] != infinity() && t_from->second[i] != infinity() &&
+                t_from->second[i] > v_from->second[i]) {
+                bound = std::max(bound, t_from->second[i] - v_from->second[i]);
+            }
+            // d(v, L) - d(t, L) <= d(v, t)
+            if (v_to[i] != infinity() && t_to[i] != infinity() && v_to[i] > t_to[i]) {
+                bound = std::max(bound, v_to[i] - t_to[i]);
+            }
+        }
+        return bound;
+    }
+
+    // Эвристика для Graph::shortest_path_astar
+    auto heuristic(const Vertex& target) const {
+        return [this, target](const Vertex& v) { return lower_bound(v, target); };
+    }
+
+    void save(std::ostream& out) const {
+        out << std::setprecision(std::numeric_limits<Distance>::max_digits10);
+        out << landmarks.size() << ' ' << from_landmarks.size() << '\n';
+
+        for (const auto& landmark : landmarks) {
+            write_value(out, landmark);
+            out << '\n';
+        }
+
+        for (const auto& [v, from] : from_landmarks) {
+            write_value(out, v);
+
+            for (const auto& d : from) {
+                out << ' ' << d;
+            }
+            for (const auto& d : to_landmarks.at(v)) {
+                out << ' ' << d;
+            }
+            out << '\n';
+        }
+    }
+
+    static LandmarkIndex load(std::istream& in) {
+        LandmarkIndex index;
+        size_t landmark_count = 0;
+        size_t vertex_count = 0;
+
+        if (!(in >> landmark_count >> vertex_count)) {
+            throw std::runtime_error("Invalid landmark index");
+        }
+
+        index.landmarks.resize(landmark_count);
+        for (auto& landmark : index.landmarks) {
+            read_value(in, landmark);
+        }
+
+        for (size_t i = 0; i < vertex_count; ++i) {
+            Vertex v;
+            std::vector<Distance> from(landmark_count);
+            std::vector<Distance> to(landmark_count);
+
+            read_value(in, v);
+            for (auto& d : from) {
+                in >> d;
+            }
+            for (auto& d : to) {
+                in >> d;
+            }
+            index.from_landmarks[v] = std::move(from);
+            index.to_landmarks[v] = std::move(to);
+        }
+
+        if (!in) {
+            throw std::runtime_error("Invalid landmark index");
+        }
+        return index;
+    }
+};
+
+// Анализ покрытия города травмпунктами: для каждой вершины известны
+// ближайший центр и расстояние от него (по направлению ребер).
+// Подсказывает, где открыть следующий центр: жадно по k-центру или по
+// выигрышу в суммарном расстоянии. Новый центр меняет метки только тех
+// вершин, к которым он ближе текущих, поэтому оценка кандидата обходит
+// лишь эту область, а не весь граф.
+template<typename Vertex, typename Distance = double>
+class CoverageAnalyzer {
+public:
+    // Эффект от открытия нового центра
+    struct Gain {
+        size_t newly_covered = 0; // ранее недостижимые вершины
+        Distance reduction{};     // уменьшение суммарного расстояния до покрытых
+
+        bool operator<(const Gain& other) const {
+            return newly_covered != other.newly_covered ? newly_covered < other.newly_covered
+                                                        : reduction < other.reduction;
+        }
+    };
+
+private:
+    using QueueItem = std::pair<Distance, size_t>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    static constexpr size_t none = std::numeric_limits<size_t>::max();
+
+    DenseGraph<Vertex, Distance> graph;
+    std::vector<size_t> centers;
+    std::vector<Distance> distances;
+    std::vector<size_t> nearest; // номер центра в centers
+    size_t threads; // для параллельной оценки кандидатов
+
+    static constexpr Distance infinity() {
+        return std::numeric_limits<Distance>::max();
+    }
+
+    // Одна Дейкстра от всех центров сразу: каждая вершина достается ближайшему центру.
+    // Деление центров между потоками не ускоряет ее: каждый поток все равно
+    // обходит почти весь граф, и работа умножается на число потоков
+    void assign_all() {
+        Queue queue;
+        distances.assign(graph.order(), infinity());
+        nearest.assign(graph.order(), none);
+
+        for (size_t i = 0; i < centers.size(); ++i) {
+            if (distances[centers[i]] != Distance{}) {
+                distances[centers[i]] = Distance{};
+                nearest[centers[i]] = i;
+                queue.push({ Distance{}, centers[i] });
+            }
+        }
+
+        while (!queue.empty()) {
+            auto [d, cur] = queue.top();
+            queue.pop();
+
+            if (d != distances[cur]) {
+                continue;
+            }
+
+            for (size_t e = graph.edges_begin(cur); e < graph.edges_end(cur); ++e) {
+                size_t next = graph.target(e);
+                Distance candidate = d + graph.weight(e);
+
+                if (candidate < distances[next]) {
+                    distances[next] = candidate;
+                    nearest[next] = nearest[cur];
+                    queue.push({ candidate, next });
+                }
+            }
+        }
+    }
+
+    // Дейкстра от кандидата с отсечением по текущим меткам: обходит только
+    // вершины, к которым кандидат ближе их центра, и передает их в visit
+    template<typename Visit>
+    void improve(size_t candidate, Visit visit) const {
+        if (!(Distance{} < distances[candidate])) {
+            return;
+        }
+
+        std::map<size_t, Distance> labels{ { candidate, Distance{} } };
+        Queue queue;
+        queue.push({ Distance{}, candidate });
+
+        while (!queue.empty()) {
+            auto [d, cur] = queue.top();
+            queue.pop();
+
+            if (d != labels[cur]) {
+                continue;
+            }
+            visit(cur, d);
+
+            for (size_t e = graph.edges_begin(cur); e < graph.edges_end(cur); ++e) {
+                size_t next = graph.target(e);
+                Distance label = d + graph.weight(e);
+
+                if (!(label < distances[next])) {
+                    continue;
+                }
+
+                auto known = labels.find(next);
+                if (known == labels.end() || label < known->second) {
+                    labels[next] = label;
+                    queue.push({ label, next });
+                }
+            }
+        }
+    }
+
+public:
+    CoverageAnalyzer(const Graph<Vertex, Distance>& g, const std::vector<Vertex>& facilities,
+        size_t thread_count = std::thread::hardware_concurrency())
+        : graph(g), threads(std::max<size_t>(thread_count, 1)) {
+        for (const auto& facility : facilities) {
+            if (!graph.has_vertex(facility)) {
+                throw std::invalid_argument("Facility vertex doesn't exist");
+            }
+            centers.push_back(graph.id(facility));
+        }
+        assign_all();
+    }
+
+    Distance distance(const Vertex& v) const {
+        return distances[graph.id(v)];
+    }
+
+    Vertex nearest_center(const Vertex& v) const {
+        size_t center = nearest[graph.id(v)];
+
+        if (center == none) {
+            throw std::runtime_error("Vertex is not covered by any center");
+        }
+        return graph.vertex(centers[center]);
+    }
+
+    size_t uncovered_count() const {
+        return std::count(distances.begin(), distances.end(), infinity());
+    }
+
+    // Радиус покрытия: наибольшее расстояние до ближайшего центра
+    Distance coverage_radius() const {
+        return distances.empty() ? Distance{} : *std::max_element(distances.begin(), distances.end());
+    }
+
+    // Самая удаленная от центров вершина - следующий центр для k-центра
+    Vertex farthest_vertex() const {
+        if (distances.empty()) {
+            throw std::runtime_error("Graph is empty");
+        }
+        return graph.vertex(std::max_element(distances.begin(), distances.end()) - distances.begin());
+    }
+
+    // Оценка кандидата без изменения текущего покрытия
+    Gain evaluate(const Vertex& candidate) const {
+        Gain gain;
+
+        improve(graph.id(candidate), [&](size_t v, const Distance& d) {
+            if (distances[v] == infinity()) {
+                ++gain.newly_covered;
+            }
+            else {
+                gain.reduction += distances[v] - d;
+            }
+        });
+        return gain;
+    }
+
+    // Лучший кандидат по выигрышу; кандидаты оцениваются параллельно
+    Vertex best_new_center(const std::vector<Vertex>& candidates) const {
+        if (candidates.empty()) {
+            throw std::invalid_argument("No candidates");
+        }
+
+        std::vector<Gain> gains(candidates.size());
+
+        DenseGraph<Vertex, Distance>::parallel_for(candidates.size(), threads, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                gains[i] = evaluate(candidates[i]);
+            }
+        }, 2);
+
+        return candidates[std::max_element(gains.begin(), gains.end()) - gains.begin()];
+    }
+
+    // Открытие центра: обновляются только улучшенные метки
+    void add_center(const Vertex& v) {
+        size_t id = graph.id(v);
+        size_t index = centers.size();
+        centers.push_back(id);
+
+        improve(id, [&](size_t u, const Distance& d) {
+            distances[u] = d;
+            nearest[u] = index;
+        });
+    }
+
+    // Жадный k-центр: k раз открывается центр в самой удаленной вершине
+    std::vector<Vertex> greedy_k_center(size_t k) {
+        std::vector<Vertex> added;
+
+        while (added.size() < k && Distance{} < coverage_radius()) {
+            added.push_back(farthest_vertex());
+            add_center(added.back());
+        }
+        return added;
+    }
+};
+
+template<typename Vertex, typename Distance = double>
+Vertex find_vertex_with_max_avg_edge_length(const Graph<Vertex, Distance>& graph) {
+    if (graph.order() == 0) {
+        throw std::runtime_error("Graph is empty");
+    }
+
+    return graph.most_isolated(1).front();
+}
+
+// Сервер запросов (query_server.cpp) подключает этот файл без main
+#ifndef AISD_NO_MAIN
+int main() {
+    Graph<std::string, double> city_graph;
+
+    city_graph.add_vertex("Hospital A");
+    city_graph.add_vertex("Hospital B");
+    city_graph.add_vertex("Hospital C");
+    city_graph.add_vertex("Hospital D");
+
+    city_graph.add_edge("Hospital A", "Hospital B", 5.0);
+    city_graph.add_edge("Hospital A", "Hospital C", 3.0);
+    city_graph.add_edge("Hospital B", "Hospital C", 2.0);
+    city_graph.add_edge("Hospital B", "Hospital D", 7.0);
+    city_graph.add_edge("Hospital C", "Hospital D", 1.0);
+    city_graph.add_edge("Hospital D", "Hospital A", 4.0);
+
+    std::string furthest = find_vertex_with_max_avg_edge_length(city_graph);
+    std::cout << "The trauma center furthest from its neighbors is " << furthest << std::endl;
+
+    double avg = city_graph.average_edge_length(furthest);
+    std::cout << "Average distance to neighbors: " << avg << std::endl;
+
+    std::cout << "Most isolated trauma centers:";
+    for (const auto& center : city_graph.most_isolated(3)) {
+        std::cout << " " << center;
+    }
+    std::cout << std::endl; // Hospital B, Hospital A, Hospital D
+
+    // Параллельный обход по снимку графа с размерами уровней
+    auto reachable = DenseGraph<std::string, double>(city_graph).walk("Hospital A");
+    std::cout << "Reachable from Hospital A: " << reachable.visited.size() << ", levels:";
+    for (size_t size : reachable.frontier_sizes) {
+        std::cout << " " << size;
+    }
+    std::cout << std::endl; // 4, levels: 1 2 1
+
+    // Перекрытие и открытие дорог с поддержанием расстояний от Hospital A и Hospital B
+    DynamicShortestPaths<std::string, double> paths(city_graph, std::vector<std::string>{ "Hospital A", "Hospital B" });
+    std::cout << "Distance A -> D: " << paths.distance("Hospital A", "Hospital D")
+        << ", from the nearest source: " << paths.distance("Hospital D") << std::endl; // 4, 3
+
+    paths.remove_edge("Hospital C", "Hospital D");
+    std::cout << "Distance A -> D after closing C -> D: " << paths.distance("Hospital A", "Hospital D")
+        << ", from the nearest source: " << paths.distance("Hospital D")
+        << " (recomputed " << paths.affected_count() << " vertices)" << std::endl; // 12, 7
+
+    paths.add_edge("Hospital C", "Hospital D", 1.0);
+    std::cout << "Distance A -> D after reopening C -> D: " << paths.distance("Hospital A", "Hospital D")
+        << ", from the nearest source: " << paths.distance("Hospital D")
+        << " (recomputed " << paths.affected_count() << " vertices)" << std::endl; // 4, 3
+
+    // Поиск пути между двумя травмпунктами: двунаправленный и A* с ориентирами
+    auto print_path = [](const std::vector<Graph<std::string, double>::Edge>& path) {
+        for (const auto& edge : path) {
+            std::cout << edge.from << " -> ";
+        }
+        std::cout << (path.empty() ? "no path" : path.back().to) << std::endl;
+    };
+
+    print_path(city_graph.shortest_path_bidirectional("Hospital A", "Hospital D")); // A -> C -> D
+
+    auto landmarks = LandmarkIndex<std::string, double>::build_async(city_graph, 2).get();
+    print_path(city_graph.shortest_path_astar("Hospital B", "Hospital A", landmarks.heuristic("Hospital A"))); // B -> C -> D -> A
+
+    // Покрытие города одним травмпунктом и выбор места для следующего
+    CoverageAnalyzer<std::string, double> coverage(city_graph, { "Hospital A" });
+    std::cout << "Coverage radius: " << coverage.coverage_radius() << std::endl; // 5
+    std::cout << "Best next center: "
+        << coverage.best_new_center(city_graph.get_vertices()) << std::endl; // Hospital B
+
+    coverage.greedy_k_center(1);
+    std::cout << "Coverage radius with k-center: " << coverage.coverage_radius()
+        << ", Hospital D served by " << coverage.nearest_center("Hospital D") << std::endl; // 3, Hospital B
 
     return 0;
 }
+#endif
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//minimal perfect hash over a fixed set of 64-bit key hashes, built the PTHash way:
+//keys are split into partitions, each partition into small buckets, and every
+//bucket gets a "pilot" that moves all its keys to free slots of the partition.
+//a lookup reads one pilot and computes the slot, n keys map onto [0, n) exactly
+class PerfectHash {
+public:
+	//splitmix64 finalizer
+	static constexpr uint64_t mix(uint64_t h) {
+		h ^= h >> 30;
+		h *= 0xBF58476D1CE4E5B9ull;
+		h ^= h >> 27;
+		h *= 0x94D049BB133111EBull;
+		h ^= h >> 31;
+		return h;
+	}
+
+	//maps the high 32 bits of h onto [0, n) without division
+	static constexpr uint64_t fastrange(uint64_t h, uint64_t n) {
+		return (h >> 32) * n >> 32;
+	}
+
+	//slot of a (mixed) hash in a partition of n keys for the given pilot
+	static constexpr uint64_t position(uint64_t h, uint32_t pilot, uint64_t n) {
+		return fastrange(mix(h ^ (pilot * 0x9E3779B97F4A7C15ull)), n);
+	}
+
+private:
+	//pilots with this bit set store the slot itself: singleton buckets are
+	//placed straight into the slots left free by the larger ones
+	static constexpr uint32_t _direct = 0x80000000u;
+	//average keys per bucket and per partition
+	static constexpr size_t _bucketLoad = 3;
+	static constexpr size_t _partitionKeys = 1 << 16;
+
+	struct Partition {
+		size_t offset;
+		uint32_t size;
+		uint32_t first_bucket;
+		uint32_t buckets;
+	};
+
+	std::vector<Partition> _partitions;
+	std::vector<uint32_t> _pilots;
+	size_t _size = 0;
+
+	static uint64_t bucketOf(uint64_t h, uint32_t buckets) {
+		return (h & 0xFFFFFFFFull) * buckets >> 32;
+	}
+
+	static void buildPartition(const uint64_t* hashes, uint32_t n, uint32_t* pilots, uint32_t buckets) {
+		//keys grouped by bucket with a counting sort
+		std::vector<uint32_t> starts(buckets + 1, 0);
+		for (uint32_t i = 0; i < n; ++i)
+			++starts[bucketOf(hashes[i], buckets) + 1];
+		for (uint32_t b = 0; b < buckets; ++b)
+			starts[b + 1] += starts[b];
+
+		std::vector<uint64_t> grouped(n);
+		std::vector<uint32_t> fill(starts.begin(), starts.end() - 1);
+		for (uint32_t i = 0; i < n; ++i)
+			grouped[fill[bucketOf(hashes[i], buckets)]++] = hashes[i];
+
+		//equal hashes share a bucket and could never be separated
+		for (uint32_t b = 0; b < buckets; ++b) {
+			std::sort(grouped.begin() + starts[b], grouped.begin() + starts[b + 1]);
+			if (std::adjacent_find(grouped.begin() + starts[b], grouped.begin() + starts[b + 1]) != grouped.begin() + starts[b + 1])
+				throw std::invalid_argument("Duplicate key hash");
+		}
+
+		//largest buckets first, while most slots are still free
+		std::vector<uint32_t> order(buckets);
+		for (uint32_t b = 0; b < buckets; ++b)
+			order[b] = b;
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+			return starts[a + 1] - starts[a] > starts[b + 1] - starts[b];
+		});
+
+		std::vector<bool> taken(n, false);
+		std::vector<uint64_t> placed;
+		size_t next = 0;
+
+		for (; next < order.size(); ++next) {
+			uint32_t b = order[next];
+			uint32_t begin = starts[b], end = starts[b + 1];
+			if (end - begin < 2)
+				break;
+
+			for (uint32_t pilot = 0;; ++pilot) {
+				if (pilot == _direct)
+					throw std::runtime_error("Perfect hash pilot search failed");
+
+				placed.clear();
+				bool fits = true;
+
+				for (uint32_t i = begin; i < end && fits; ++i) {
+					uint64_t pos = position(grouped[i], pilot, n);
+					if (taken[pos])
+						fits = false;
+					else {
+						taken[pos] = true;
+						placed.push_back(pos);
+					}
+				}
+
+				if (fits) {
+					pilots[b] = pilot;
+					break;
+				}
+				for (uint64_t pos : placed)
+					taken[pos] = false;
+			}
+		}
+
+		uint32_t slot = 0;
+		for (; next < order.size(); ++next) {
+			uint32_t b = order[next];
+			if (starts[b + 1] == starts[b]) {
+				pilots[b] = 0;
+				continue;
+			}
+			while (taken[slot])
+				++slot;
+			taken[slot] = true;
+			pilots[b] = _direct | slot;
+		}
+	}
+
+public:
+	PerfectHash() = default;
+
+	//hashes must be distinct; partitions are built on up to threads threads
+	explicit PerfectHash(const std::vector<uint64_t>& hashes, size_t threads = std::thread::hardware_concurrency())
+		: _size(hashes.size()) {
+		if (hashes.size() >= _direct)
+			throw std::invalid_argument("Too many keys for a perfect hash");
+
+		size_t count = hashes.size() / _partitionKeys + 1;
+
+		//partition of every key by the high half of its hash
+		std::vector<uint64_t> mixed(hashes.size());
+		std::vector<size_t> starts(count + 1, 0);
+		for (size_t i = 0; i < hashes.size(); ++i) {
+			mixed[i] = mix(hashes[i]);
+			++starts[fastrange(mixed[i], count) + 1];
+		}
+		for (size_t p = 0; p < count; ++p)
+			starts[p + 1] += starts[p];
+
+		std::vector<uint64_t> grouped(hashes.size());
+		std::vector<size_t> fill(starts.begin(), starts.end() - 1);
+		for (uint64_t h : mixed)
+			grouped[fill[fastrange(h, count)]++] = h;
+
+		_partitions.resize(count);
+		uint32_t buckets = 0;
+		for (size_t p = 0; p < count; ++p) {
+			Partition& part = _partitions[p];
+			part.offset = starts[p];
+			part.size = static_cast<uint32_t>(starts[p + 1] - starts[p]);
+			part.first_bucket = buckets;
+			part.buckets = static_cast<uint32_t>(part.size / _bucketLoad + 1);
+			buckets += part.buckets;
+		}
+		_pilots.assign(buckets, 0);
+
+		auto build = [&](size_t begin, size_t end) {
+			for (size_t p = begin; p < end; ++p) {
+				const Partition& part = _partitions[p];
+				buildPartition(grouped.data() + part.offset, part.size, _pilots.data() + part.first_bucket, part.buckets);
+			}
+		};
+
+		if (threads <= 1 || count < 2) {
+			build(0, count);
+			return;
+		}
+
+		//a failed partition rethrows its exception on the calling thread
+		std::vector<std::thread> workers;
+		std::vector<std::exception_ptr> errors(threads);
+		size_t chunk = (count + threads - 1) / threads;
+
+		for (size_t t = 0; t < threads && t * chunk < count; ++t) {
+			workers.emplace_back([&, t] {
+				try {
+					build(t * chunk, std::min(count, (t + 1) * chunk));
+				}
+				catch (...) {
+					errors[t] = std::current_exception();
+				}
+			});
+		}
+		for (auto& worker : workers)
+			worker.join();
+		for (auto& error : errors) {
+			if (error)
+				std::rethrow_exception(error);
+		}
+	}
+
+	size_t size() const {
+		return _size;
+	}
+
+	//slot in [0, size()) of a hash from the build set; any slot for other hashes
+	size_t slot(uint64_t hash) const {
+		uint64_t h = mix(hash);
+		const Partition& part = _partitions[fastrange(h, _partitions.size())];
+		uint32_t pilot = _pilots[part.first_bucket + bucketOf(h, part.buckets)];
+
+		if (pilot & _direct)
+			return part.offset + (pilot & ~_direct);
+		return part.offset + position(h, pilot, part.size);
+	}
+
+	size_t memory_bytes() const {
+		return _partitions.size() * sizeof(Partition) + _pilots.size() * sizeof(uint32_t);
+	}
+};
+
+//perfect hash over N keys known at compile time (integers or string literals):
+//the pilots are searched by the constexpr constructor, find() costs one probe
+template<typename K, size_t N>
+class StaticPerfectHash {
+	static constexpr size_t _buckets = N / 2 + 1;
+
+	std::array<uint32_t, _buckets> _pilots{};
+	std::array<K, N> _keys{};
+
+	static constexpr uint64_t hashKey(const K& key) {
+		if constexpr (std::is_integral<K>::value) {
+			return PerfectHash::mix(static_cast<uint64_t>(key));
+		}
+		else {
+			//FNV-1a, std::hash is not constexpr
+			std::string_view text = key;
+			uint64_t h = 0xCBF29CE484222325ull;
+			for (char c : text) {
+				h ^= static_cast<unsigned char>(c);
+				h *= 0x100000001B3ull;
+			}
+			return PerfectHash::mix(h);
+		}
+	}
+
+	static constexpr size_t bucketOf(uint64_t h) {
+		return (h & 0xFFFFFFFFull) * _buckets >> 32;
+	}
+
+public:
+	constexpr explicit StaticPerfectHash(const std::array<K, N>& keys) {
+		std::array<uint64_t, N> hashes{};
+		std::array<size_t, N> bucket{};
+		std::array<size_t, _buckets> sizes{};
+		std::array<size_t, _buckets> order{};
+
+		for (size_t i = 0; i < N; ++i) {
+			hashes[i] = hashKey(keys[i]);
+			bucket[i] = bucketOf(hashes[i]);
+			++sizes[bucket[i]];
+			for (size_t j = 0; j < i; ++j) {
+				if (hashes[j] == hashes[i])
+					throw std::invalid_argument("Duplicate key");
+			}
+		}
+
+		//largest buckets first (insertion sort, N is small)
+		for (size_t b = 0; b < _buckets; ++b) {
+			size_t i = b;
+			for (; i > 0 && sizes[order[i - 1]] < sizes[b]; --i)
+				order[i] = order[i - 1];
+			order[i] = b;
+		}
+
+		std::array<bool, N> taken{};
+		std::array<size_t, N> placed{};
+
+		for (size_t b : order) {
+			if (sizes[b] == 0)
+				break;
+
+			for (uint32_t pilot = 0;; ++pilot) {
+				size_t count = 0;
+				bool fits = true;
+
+				for (size_t i = 0; i < N && fits; ++i) {
+					if (bucket[i] != b)
+						continue;
+
+					size_t pos = static_cast<size_t>(PerfectHash::position(hashes[i], pilot, N));
+					if (taken[pos])
+						fits = false;
+					else {
+						taken[pos] = true;
+						placed[count++] = pos;
+						_keys[pos] = keys[i];
+					}
+				}
+
+				if (fits) {
+					_pilots[b] = pilot;
+					break;
+				}
+				for (size_t i = 0; i < count; ++i)
+					taken[placed[i]] = false;
+			}
+		}
+	}
+
+	//index of the key in [0, N), or N if it is not in the set
+	constexpr size_t find(const K& key) const {
+		if constexpr (N == 0) {
+			return 0;
+		}
+		else {
+			uint64_t h = hashKey(key);
+			size_t pos = static_cast<size_t>(PerfectHash::position(h, _pilots[bucketOf(h)], N));
+			return _keys[pos] == key ? pos : N;
+		}
+	}
+
+	constexpr bool contains(const K& key) const {
+		return find(key) != N;
+	}
+
+	static constexpr size_t size() {
+		return N;
+	}
+};
@@ -0,0 +1,678 @@
+//Локальный сервер запросов к контейнерам лабораторных: HashTable, BinaryTree и Graph.
+//Клиенты подключаются по Unix domain socket и шлют запросы конвейером, не дожидаясь ответов.
+//Сервер за один проход epoll читает всё, что пришло от всех клиентов, выполняет
+//запросы одной пачкой (запросы к графу с общим источником считаются одним Дейкстрой,
+//расстояния от недавних источников хранятся, пока сервер работает)
+//и отвечает каждому клиенту в порядке его запросов одной записью в сокет.
+//
+//Протокол: запрос и ответ - структуры фиксированного размера по 16 байт (порядок байт машины):
+//  Request  { uint32 id; uint8 op; uint8[3]; int32 a; int32 b; }
+//  Response { uint32 id; uint8 status; uint8[3]; double value; }
+//  op: 1 - поиск ключа a в HashTable (value - значение), 2 - наличие ключа a в BinaryTree,
+//      3 - расстояние от вершины a до вершины b в Graph
+//  status: 0 - найдено, 1 - не найдено, 2 - неизвестная операция
+//
+//Запуск:
+//  query_server                                        - сервер и нагрузочный тест в одном процессе
+//  query_server serve PATH                             - только сервер
+//  query_server bench PATH CONNECTIONS REQUESTS DEPTH  - нагрузочный тест против запущенного сервера
+//
+//Сборка (только Linux): g++ -std=c++17 -O2 -pthread query_server.cpp -o query_server
+
+#define AISD_NO_MAIN
+#include "lab1.cpp"
+#include "lab2.cpp"
+#include "lab3.cpp"
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <cstring>
+#include <unordered_map>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+enum QueryOp : uint8_t { HashSearch = 1, TreeContains = 2, GraphDistance = 3 };
+enum QueryStatus : uint8_t { Found = 0, NotFound = 1, BadRequest = 2 };
+
+struct Request {
+    uint32_t id;
+    uint8_t op;
+    uint8_t reserved[3];
+    int32_t a;
+    int32_t b;
+};
+
+struct Response {
+    uint32_t id;
+    uint8_t status;
+    uint8_t reserved[3];
+    double value;
+};
+
+static_assert(sizeof(Request) == 16 && sizeof(Response) == 16, "Wire format expects 16-byte frames");
+
+[[noreturn]] void throw_errno(const char* what) {
+    throw std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+}
+
+sockaddr_un socket_address(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path is too long");
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+// Сервер: однопоточный цикл epoll, все контейнеры читаются только из него
+class QueryServer {
+    struct Connection {
+        int fd;
+        std::vector<char> in;
+        std::vector<char> out;
+        size_t out_pos = 0;
+        // Подписка epoll; EPOLLIN снимается, пока клиент не забирает ответы
+        uint32_t events = EPOLLIN;
+        // Клиент закончил передачу запросов (shutdown(SHUT_WR) или close)
+        bool finished = false;
+    };
+
+    // Запрос пачки вместе с соединением, которому нужен ответ
+    struct Pending {
+        uint64_t connection;
+        Request request;
+    };
+
+    static constexpr uint64_t listener_id = 0;
+    // Граф не меняется, пока работает сервер, поэтому расстояния от источника можно хранить
+    static constexpr size_t cached_sources = 64;
+    // Не больше read_limit байт с соединения за пробуждение, чтобы один клиент не задерживал пачку;
+    // чтение приостанавливается, пока неотправленных ответов больше out_high_water байт
+    static constexpr size_t read_limit = 1 << 16;
+    static constexpr size_t out_high_water = 1 << 20;
+
+    HashTable<int, int>& table;
+    const BinaryTree<int>& tree;
+    const Graph<int, double>& graph;
+
+    int listen_fd = -1;
+    int epoll_fd = -1;
+    // Прием приостановлен после ошибки accept4 (например, кончились дескрипторы)
+    bool accept_paused = false;
+    uint64_t next_id = 1;
+    std::unordered_map<uint64_t, Connection> connections;
+
+    std::vector<Pending> batch;
+    std::vector<Response> responses;
+    std::vector<size_t> graph_queries;
+    std::unordered_map<int, std::map<int, double>> distance_cache;
+
+    size_t batches = 0;
+    size_t requests = 0;
+
+    void watch(int fd, uint64_t id, uint32_t events, int operation) {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = id;
+        if (epoll_ctl(epoll_fd, operation, fd, &event) < 0) {
+            throw_errno("epoll_ctl");
+        }
+    }
+
+    // Ошибка приема не останавливает сервер: оборванное клиентом подключение пропускается,
+    // а при нехватке ресурсов прием приостанавливается до закрытия соединения или простоя,
+    // иначе слушающий сокет будет будить epoll без конца
+    void accept_all() {
+        for (;;) {
+            int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                    return;
+                }
+
+                std::cerr << "accept4: " << std::strerror(errno) << std::endl;
+                if (errno == ECONNABORTED || errno == EPROTO || errno == EPERM) {
+                    continue;
+                }
+                pause_accept(true);
+                return;
+            }
+
+            uint64_t id = next_id++;
+            connections[id].fd = fd;
+            watch(fd, id, EPOLLIN, EPOLL_CTL_ADD);
+        }
+    }
+
+    void pause_accept(bool pause) {
+        if (pause != accept_paused) {
+            watch(listen_fd, listener_id, pause ? 0 : static_cast<uint32_t>(EPOLLIN), EPOLL_CTL_MOD);
+            accept_paused = pause;
+        }
+    }
+
+    void close_connection(uint64_t id) {
+        auto it = connections.find(id);
+        if (it != connections.end()) {
+            close(it->second.fd);
+            connections.erase(it);
+            pause_accept(false);
+        }
+    }
+
+    // Читает до read_limit байт и переносит целые запросы в пачку; false - ошибка чтения.
+    // Конец потока только отмечается: запросы, пришедшие до него, выполняются и получают ответы
+    bool read_requests(uint64_t id, Connection& connection) {
+        for (size_t total = 0; total < read_limit;) {
+            size_t old_size = connection.in.size();
+            size_t chunk = read_limit - total;
+            connection.in.resize(old_size + chunk);
+            ssize_t received = read(connection.fd, connection.in.data() + old_size, chunk);
+            connection.in.resize(old_size + std::max<ssize_t>(received, 0));
+
+            if (received == 0) {
+                connection.finished = true;
+                break;
+            }
+            if (received < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            total += received;
+        }
+
+        size_t complete = connection.in.size() / sizeof(Request) * sizeof(Request);
+        for (size_t offset = 0; offset < complete; offset += sizeof(Request)) {
+            Pending pending{ id, {} };
+            std::memcpy(&pending.request, connection.in.data() + offset, sizeof(Request));
+            batch.push_back(pending);
+        }
+        connection.in.erase(connection.in.begin(), connection.in.begin() + complete);
+        return true;
+    }
+
+    // Пачка выполняется целиком: поиск в таблице и дереве по порядку,
+    // запросы к графу группируются по источнику, и Дейкстра запускается не чаще раза на источник
+    void execute() {
+        responses.assign(batch.size(), Response{});
+        graph_queries.clear();
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const Request& request = batch[i].request;
+            Response& response = responses[i];
+            response.id = request.id;
+            response.status = NotFound;
+
+            switch (request.op) {
+            case HashSearch:
+                if (const int* value = table.search(request.a)) {
+                    response.status = Found;
+                    response.value = *value;
+                }
+                break;
+            case TreeContains:
+                if (tree.contains(request.a)) {
+                    response.status = Found;
+                }
+                break;
+            case GraphDistance:
+                graph_queries.push_back(i);
+                break;
+            default:
+                response.status = BadRequest;
+                break;
+            }
+        }
+
+        std::stable_sort(graph_queries.begin(), graph_queries.end(), [&](size_t x, size_t y) {
+            return batch[x].request.a < batch[y].request.a;
+        });
+
+        for (size_t begin = 0, end = 0; begin < graph_queries.size(); begin = end) {
+            int source = batch[graph_queries[begin]].request.a;
+            while (end < graph_queries.size() && batch[graph_queries[end]].request.a == source) {
+                ++end;
+            }
+            if (!graph.has_vertex(source)) {
+                continue;
+            }
+
+            auto cached = distance_cache.find(source);
+            if (cached == distance_cache.end()) {
+                if (distance_cache.size() >= cached_sources) {
+                    distance_cache.clear();
+                }
+                cached = distance_cache.emplace(source, graph.distances_from(source)).first;
+            }
+
+            const std::map<int, double>& distances = cached->second;
+            for (size_t k = begin; k < end; ++k) {
+                auto it = distances.find(batch[graph_queries[k]].request.b);
+                if (it != distances.end()) {
+                    responses[graph_queries[k]].status = Found;
+                    responses[graph_queries[k]].value = it->second;
+                }
+            }
+        }
+
+        ++batches;
+        requests += batch.size();
+    }
+
+    // Пишет накопленные ответы; остаток дописывается по EPOLLOUT.
+    // false - соединение можно закрыть: ошибка записи или клиент закончил и получил все ответы
+    bool flush(uint64_t id, Connection& connection) {
+        while (connection.out_pos < connection.out.size()) {
+            ssize_t sent = send(connection.fd, connection.out.data() + connection.out_pos,
+                connection.out.size() - connection.out_pos, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                return false;
+            }
+            connection.out_pos += sent;
+        }
+
+        // Отправленное начало буфера удаляется, когда занимает больше половины
+        if (connection.out_pos * 2 >= connection.out.size()) {
+            connection.out.erase(connection.out.begin(), connection.out.begin() + connection.out_pos);
+            connection.out_pos = 0;
+        }
+
+        size_t unsent = connection.out.size() - connection.out_pos;
+        if (connection.finished && unsent == 0) {
+            return false;
+        }
+
+        uint32_t events = (!connection.finished && unsent <= out_high_water ? static_cast<uint32_t>(EPOLLIN) : 0)
+            | (unsent > 0 ? static_cast<uint32_t>(EPOLLOUT) : 0);
+        if (events != connection.events) {
+            watch(connection.fd, id, events, EPOLL_CTL_MOD);
+            connection.events = events;
+        }
+        return true;
+    }
+
+public:
+    QueryServer(HashTable<int, int>& table, const BinaryTree<int>& tree, const Graph<int, double>& graph, const std::string& path)
+        : table(table), tree(tree), graph(graph) {
+        sockaddr_un address = socket_address(path);
+        unlink(path.c_str());
+
+        listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd < 0) {
+            throw_errno("socket");
+        }
+        if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listen_fd, SOMAXCONN) < 0) {
+            int error = errno;
+            close(listen_fd);
+            errno = error;
+            throw_errno("bind");
+        }
+
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd < 0) {
+            int error = errno;
+            close(listen_fd);
+            errno = error;
+            throw_errno("epoll_create1");
+        }
+        watch(listen_fd, listener_id, EPOLLIN, EPOLL_CTL_ADD);
+    }
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    ~QueryServer() {
+        for (auto& [id, connection] : connections) {
+            close(connection.fd);
+        }
+        close(epoll_fd);
+        close(listen_fd);
+    }
+
+    // Обслуживает клиентов, пока не выставлен stop
+    void run(const std::atomic<bool>& stop) {
+        epoll_event events[64];
+
+        while (!stop) {
+            int ready = epoll_wait(epoll_fd, events, 64, 100);
+            if (ready < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw_errno("epoll_wait");
+            }
+            if (ready == 0) {
+                pause_accept(false);
+            }
+
+            batch.clear();
+            std::vector<uint64_t> writable;
+
+            for (int i = 0; i < ready; ++i) {
+                uint64_t id = events[i].data.u64;
+                if (id == listener_id) {
+                    accept_all();
+                    continue;
+                }
+
+                auto it = connections.find(id);
+                if (it == connections.end()) {
+                    continue;
+                }
+                // Без подписки на EPOLLIN соединение не читается, даже если пришли данные или обрыв:
+                // обрыв проявится ошибкой записи
+                Connection& connection = it->second;
+                if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && (connection.events & EPOLLIN)
+                    && !read_requests(id, connection)) {
+                    close_connection(id);
+                    continue;
+                }
+                if ((events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) || connection.finished) {
+                    writable.push_back(id);
+                }
+            }
+
+            if (!batch.empty()) {
+                execute();
+            }
+
+            // Ответы дописываются в порядке пачки, то есть в порядке запросов каждого клиента
+            for (size_t i = 0; i < batch.size(); ++i) {
+                auto it = connections.find(batch[i].connection);
+                if (it == connections.end()) {
+                    continue;
+                }
+                const char* bytes = reinterpret_cast<const char*>(&responses[i]);
+                it->second.out.insert(it->second.out.end(), bytes, bytes + sizeof(Response));
+                if (writable.empty() || writable.back() != batch[i].connection) {
+                    writable.push_back(batch[i].connection);
+                }
+            }
+
+            for (uint64_t id : writable) {
+                auto it = connections.find(id);
+                if (it != connections.end() && !flush(id, it->second)) {
+                    close_connection(id);
+                }
+            }
+        }
+    }
+
+    size_t batch_count() const {
+        return batches;
+    }
+
+    size_t request_count() const {
+        return requests;
+    }
+};
+
+// Нагрузочный тест: connections клиентов, у каждого до depth запросов в полёте
+struct LoadReport {
+    double seconds = 0;
+    size_t requests = 0;
+    size_t found = 0;
+    std::vector<double> latencies_us;
+
+    double percentile(double p) const {
+        if (latencies_us.empty()) {
+            return 0;
+        }
+        return latencies_us[std::min(latencies_us.size() - 1, static_cast<size_t>(p * latencies_us.size()))];
+    }
+};
+
+struct Workload {
+    int key_range;
+    int vertex_count;
+    int sources;
+};
+
+int connect_unix(const std::string& path) {
+    sockaddr_un address = socket_address(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw_errno("socket");
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        throw_errno("connect");
+    }
+    return fd;
+}
+
+void write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = write(fd, data, size);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("write");
+        }
+        data += sent;
+        size -= sent;
+    }
+}
+
+// Один клиент: запросы уходят пачками по мере освобождения окна
+void run_client(const std::string& path, size_t count, size_t depth, const Workload& workload, uint32_t seed,
+    std::vector<double>& latencies, size_t& found) {
+    using Clock = std::chrono::steady_clock;
+
+    int fd = connect_unix(path);
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> key_dist(0, workload.key_range - 1);
+    std::uniform_int_distribution<int> vertex_dist(0, workload.vertex_count - 1);
+    std::uniform_int_distribution<int> source_dist(0, workload.sources - 1);
+    std::uniform_int_distribution<int> op_dist(0, 99);
+
+    std::vector<Clock::time_point> sent_at(count);
+    std::vector<Request> outgoing;
+    std::vector<char> incoming;
+    size_t next = 0, done = 0;
+
+    auto send = [&](size_t window) {
+        outgoing.clear();
+        for (; window > 0 && next < count; --window, ++next) {
+            Request request{};
+            request.id = static_cast<uint32_t>(next);
+            int op = op_dist(gen);
+            request.op = op < 49 ? HashSearch : op < 98 ? TreeContains : GraphDistance;
+            request.a = request.op == GraphDistance ? source_dist(gen) : key_dist(gen);
+            request.b = vertex_dist(gen);
+            outgoing.push_back(request);
+            sent_at[next] = Clock::now();
+        }
+        write_all(fd, reinterpret_cast<const char*>(outgoing.data()), outgoing.size() * sizeof(Request));
+    };
+
+    send(depth);
+    while (done < count) {
+        size_t old_size = incoming.size();
+        incoming.resize(old_size + 65536);
+        ssize_t received = read(fd, incoming.data() + old_size, 65536);
+        if (received <= 0) {
+            if (received < 0 && errno == EINTR) {
+                incoming.resize(old_size);
+                continue;
+            }
+            close(fd);
+            throw std::runtime_error("Server closed the connection");
+        }
+        incoming.resize(old_size + received);
+
+        Clock::time_point now = Clock::now();
+        size_t complete = incoming.size() / sizeof(Response);
+        for (size_t i = 0; i < complete; ++i) {
+            Response response;
+            std::memcpy(&response, incoming.data() + i * sizeof(Response), sizeof(Response));
+            latencies.push_back(std::chrono::duration<double, std::micro>(now - sent_at[response.id]).count());
+            found += response.status == Found;
+        }
+        incoming.erase(incoming.begin(), incoming.begin() + complete * sizeof(Response));
+        done += complete;
+        send(complete);
+    }
+    close(fd);
+}
+
+LoadReport run_load(const std::string& path, size_t connections, size_t count, size_t depth, const Workload& workload) {
+    std::vector<std::vector<double>> latencies(connections);
+    std::vector<size_t> found(connections, 0);
+    std::vector<std::exception_ptr> errors(connections);
+    std::vector<std::thread> clients;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < connections; ++c) {
+        clients.emplace_back([&, c] {
+            try {
+                run_client(path, count, std::max<size_t>(depth, 1), workload, static_cast<uint32_t>(c + 1), latencies[c], found[c]);
+            }
+            catch (...) {
+                errors[c] = std::current_exception();
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    LoadReport report;
+    report.seconds = std::chrono::duration<double>(end - start).count();
+    for (size_t c = 0; c < connections; ++c) {
+        report.latencies_us.insert(report.latencies_us.end(), latencies[c].begin(), latencies[c].end());
+        report.found += found[c];
+    }
+    report.requests = report.latencies_us.size();
+    std::sort(report.latencies_us.begin(), report.latencies_us.end());
+    return report;
+}
+
+void print_report(const char* title, const LoadReport& report) {
+    printf("%-24s | %9zu requests | %10.0f req/s | p50 %8.1f us | p99 %8.1f us | p99.9 %8.1f us\n",
+        title, report.requests, report.requests / report.seconds,
+        report.percentile(0.5), report.percentile(0.99), report.percentile(0.999));
+}
+
+// Данные сервера: ключи 0, 2, 4, ... в таблице и дереве, случайный граф на vertex_count вершинах
+struct Dataset {
+    static constexpr int keys = 100000;
+    static constexpr int vertex_count = 2000;
+    static constexpr int sources = 8;
+
+    HashTable<int, int> table{ 1 << 16 };
+    BinaryTree<int> tree;
+    Graph<int, double> graph;
+
+    Dataset() {
+        for (int i = 0; i < keys; i += 2) {
+            table.insert(i, i * 10);
+            tree.insert(i);
+        }
+
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> vertex_dist(0, vertex_count - 1);
+        std::uniform_real_distribution<double> weight_dist(1.0, 10.0);
+
+        for (int v = 0; v < vertex_count; ++v) {
+            graph.add_vertex(v);
+        }
+        for (int v = 0; v < vertex_count; ++v) {
+            graph.add_edge(v, (v + 1) % vertex_count, weight_dist(gen));
+            for (int e = 0; e < 4; ++e) {
+                graph.add_edge(v, vertex_dist(gen), weight_dist(gen));
+            }
+        }
+    }
+
+    Workload workload() const {
+        return { keys, vertex_count, sources };
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    try {
+        if (args.size() == 2 && args[0] == "serve") {
+            Dataset data;
+            std::atomic<bool> stop{ false };
+            QueryServer server(data.table, data.tree, data.graph, args[1]);
+            std::cout << "Serving on " << args[1] << std::endl;
+            server.run(stop);
+            return 0;
+        }
+
+        if (args.size() == 5 && args[0] == "bench") {
+            Workload workload{ Dataset::keys, Dataset::vertex_count, Dataset::sources };
+            LoadReport report = run_load(args[1], std::stoul(args[2]), std::stoul(args[3]), std::stoul(args[4]), workload);
+            print_report("bench", report);
+            return 0;
+        }
+
+        if (!args.empty()) {
+            std::cerr << "Usage: query_server [serve PATH | bench PATH CONNECTIONS REQUESTS DEPTH]" << std::endl;
+            return 1;
+        }
+
+        // Сервер и клиенты в одном процессе: без конвейера и с окном в 32 запроса
+        std::string path = "/tmp/aisd_query_server." + std::to_string(getpid()) + ".sock";
+        Dataset data;
+        std::atomic<bool> stop{ false };
+        QueryServer server(data.table, data.tree, data.graph, path);
+        std::thread serving([&] { server.run(stop); });
+
+        for (size_t depth : { 1, 8, 32 }) {
+            size_t batches = server.batch_count(), requests = server.request_count();
+            LoadReport report = run_load(path, 4, 20000, depth, data.workload());
+            std::string title = "4 clients, depth " + std::to_string(depth);
+            print_report(title.c_str(), report);
+            printf("%-24s | %9.1f requests per batch, %zu found\n", "",
+                double(server.request_count() - requests) / std::max<size_t>(server.batch_count() - batches, 1), report.found);
+        }
+
+        stop = true;
+        serving.join();
+        unlink(path.c_str());
+    }
+    catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+#else
+
+int main() {
+    std::cout << "Query server requires Linux (epoll and Unix domain sockets)" << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,505 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//compressed set of unsigned 32-bit integers in the style of roaring bitmaps.
+//values are grouped into 64K chunks by their high 16 bits, and every chunk keeps
+//its low halves in the smallest container: a sorted array for sparse chunks,
+//a 65536-bit bitmap for dense ones, or a list of runs after run_optimize
+class RoaringSet {
+	//above 4096 values a sorted array takes more than the 8 KB of a bitmap
+	static constexpr uint32_t _arrayLimit = 4096;
+	static constexpr size_t _bitmapWords = 65536 / 64;
+
+	enum class Kind : uint8_t { Array, Bitmap, Run };
+
+	struct Container {
+		Kind kind = Kind::Array;
+		uint32_t cardinality = 0;
+		//Array: sorted values, Run: pairs of (start, length - 1)
+		std::vector<uint16_t> values;
+		//Bitmap: _bitmapWords words
+		std::vector<uint64_t> bits;
+	};
+
+	std::vector<uint16_t> _keys;
+	std::vector<Container> _chunks;
+	size_t _size = 0;
+
+	static uint32_t popcount(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<uint32_t>(__builtin_popcountll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return static_cast<uint32_t>(__popcnt64(x));
+#else
+		x = x - ((x >> 1) & 0x5555555555555555ull);
+		x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+		x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return static_cast<uint32_t>((x * 0x0101010101010101ull) >> 56);
+#endif
+	}
+
+	static uint32_t popcount(const std::vector<uint64_t>& bits) {
+		uint32_t result = 0;
+		for (uint64_t word : bits)
+			result += popcount(word);
+		return result;
+	}
+
+	//calls f for every value of the chunk in ascending order
+	template<typename F>
+	static void forEach(const Container& c, uint32_t base, F&& f) {
+		switch (c.kind) {
+		case Kind::Array:
+			for (uint16_t low : c.values)
+				f(base | low);
+			break;
+		case Kind::Bitmap:
+			for (size_t i = 0; i < _bitmapWords; ++i) {
+				for (uint64_t word = c.bits[i]; word != 0; word &= word - 1) {
+					uint32_t bit = popcount((word & (0 - word)) - 1);
+					f(base | static_cast<uint32_t>(i * 64 + bit));
+				}
+			}
+			break;
+		case Kind::Run:
+			for (size_t i = 0; i < c.values.size(); i += 2) {
+				uint32_t start = c.values[i];
+				for (uint32_t low = start; low <= start + c.values[i + 1]; ++low)
+					f(base | low);
+			}
+			break;
+		}
+	}
+
+	static bool containerContains(const Container& c, uint16_t low) {
+		switch (c.kind) {
+		case Kind::Array:
+			return std::binary_search(c.values.begin(), c.values.end(), low);
+		case Kind::Bitmap:
+			return (c.bits[low >> 6] >> (low & 63)) & 1;
+		case Kind::Run: {
+			//last run starting at or before low
+			size_t lo = 0, hi = c.values.size() / 2;
+			while (lo < hi) {
+				size_t mid = (lo + hi) / 2;
+				if (c.values[2 * mid] <= low)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			return lo > 0 && low - c.values[2 * (lo - 1)] <= c.values[2 * (lo - 1) + 1];
+		}
+		}
+		return false;
+	}
+
+	static void setRange(std::vector<uint64_t>& bits, uint32_t first, uint32_t last) {
+		for (uint32_t word = first >> 6; word <= last >> 6; ++word) {
+			uint64_t mask = ~uint64_t(0);
+			if (word == first >> 6)
+				mask &= ~uint64_t(0) << (first & 63);
+			if (word == last >> 6)
+				mask &= ~uint64_t(0) >> (63 - (last & 63));
+			bits[word] |= mask;
+		}
+	}
+
+	static std::vector<uint64_t> bitmapOf(const Container& c) {
+		if (c.kind == Kind::Bitmap)
+			return c.bits;
+
+		std::vector<uint64_t> bits(_bitmapWords, 0);
+		if (c.kind == Kind::Array) {
+			for (uint16_t low : c.values)
+				bits[low >> 6] |= uint64_t(1) << (low & 63);
+		}
+		else {
+			for (size_t i = 0; i < c.values.size(); i += 2)
+				setRange(bits, c.values[i], uint32_t(c.values[i]) + c.values[i + 1]);
+		}
+		return bits;
+	}
+
+	static void toBitmap(Container& c) {
+		c.bits = bitmapOf(c);
+		c.values.clear();
+		c.values.shrink_to_fit();
+		c.kind = Kind::Bitmap;
+	}
+
+	static void toArray(Container& c) {
+		std::vector<uint16_t> values;
+		values.reserve(c.cardinality);
+		forEach(c, 0, [&](uint32_t low) { values.push_back(static_cast<uint16_t>(low)); });
+
+		c.values = std::move(values);
+		c.bits.clear();
+		c.bits.shrink_to_fit();
+		c.kind = Kind::Array;
+	}
+
+	static void toRun(Container& c) {
+		std::vector<uint16_t> runs;
+		forEach(c, 0, [&](uint32_t low) {
+			if (!runs.empty() && uint32_t(runs[runs.size() - 2]) + runs.back() + 1 == low)
+				++runs.back();
+			else {
+				runs.push_back(static_cast<uint16_t>(low));
+				runs.push_back(0);
+			}
+		});
+
+		c.values = std::move(runs);
+		c.bits.clear();
+		c.bits.shrink_to_fit();
+		c.kind = Kind::Run;
+	}
+
+	//runs are only kept until the next change of the chunk
+	static void unpackRun(Container& c) {
+		if (c.kind == Kind::Run) {
+			if (c.cardinality <= _arrayLimit)
+				toArray(c);
+			else
+				toBitmap(c);
+		}
+	}
+
+	//keeps arrays and bitmaps on the right side of _arrayLimit
+	static void normalize(Container& c) {
+		if (c.kind == Kind::Array && c.cardinality > _arrayLimit)
+			toBitmap(c);
+		else if (c.kind == Kind::Bitmap && c.cardinality <= _arrayLimit)
+			toArray(c);
+	}
+
+	static size_t countRuns(const Container& c) {
+		if (c.kind == Kind::Run)
+			return c.values.size() / 2;
+
+		size_t runs = 0;
+		if (c.kind == Kind::Array) {
+			for (size_t i = 0; i < c.values.size(); ++i)
+				runs += (i == 0 || c.values[i] != c.values[i - 1] + 1);
+		}
+		else {
+			//a run starts at every set bit whose lower neighbour is clear
+			uint64_t carry = 0;
+			for (uint64_t word : c.bits) {
+				runs += popcount(word & ~((word << 1) | carry));
+				carry = word >> 63;
+			}
+		}
+		return runs;
+	}
+
+	static Container fromBitmap(std::vector<uint64_t>&& bits) {
+		Container c;
+		c.kind = Kind::Bitmap;
+		c.cardinality = popcount(bits);
+		c.bits = std::move(bits);
+		normalize(c);
+		return c;
+	}
+
+	static Container fromArray(std::vector<uint16_t>&& values) {
+		Container c;
+		c.cardinality = static_cast<uint32_t>(values.size());
+		c.values = std::move(values);
+		normalize(c);
+		return c;
+	}
+
+	static Container unite(const Container& a, const Container& b) {
+		if (a.kind == Kind::Array && b.kind == Kind::Array) {
+			std::vector<uint16_t> values;
+			values.reserve(a.values.size() + b.values.size());
+			std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(values));
+			return fromArray(std::move(values));
+		}
+
+		const Container& dense = a.kind == Kind::Array ? b : a;
+		const Container& other = a.kind == Kind::Array ? a : b;
+		std::vector<uint64_t> bits = bitmapOf(dense);
+
+		if (other.kind == Kind::Array) {
+			for (uint16_t low : other.values)
+				bits[low >> 6] |= uint64_t(1) << (low & 63);
+		}
+		else {
+			std::vector<uint64_t> more = bitmapOf(other);
+			for (size_t i = 0; i < _bitmapWords; ++i)
+				bits[i] |= more[i];
+		}
+		return fromBitmap(std::move(bits));
+	}
+
+	static Container intersect(const Container& a, const Container& b) {
+		if (a.kind == Kind::Array || b.kind == Kind::Array) {
+			const Container& sparse = a.kind == Kind::Array ? a : b;
+			const Container& other = a.kind == Kind::Array ? b : a;
+			std::vector<uint16_t> values;
+
+			if (other.kind == Kind::Array)
+				std::set_intersection(sparse.values.begin(), sparse.values.end(),
+					other.values.begin(), other.values.end(), std::back_inserter(values));
+			else {
+				for (uint16_t low : sparse.values) {
+					if (containerContains(other, low))
+						values.push_back(low);
+				}
+			}
+			return fromArray(std::move(values));
+		}
+
+		std::vector<uint64_t> bits = bitmapOf(a);
+		std::vector<uint64_t> mask = bitmapOf(b);
+		for (size_t i = 0; i < _bitmapWords; ++i)
+			bits[i] &= mask[i];
+		return fromBitmap(std::move(bits));
+	}
+
+	static Container subtract(const Container& a, const Container& b) {
+		if (a.kind == Kind::Array) {
+			std::vector<uint16_t> values;
+			for (uint16_t low : a.values) {
+				if (!containerContains(b, low))
+					values.push_back(low);
+			}
+			return fromArray(std::move(values));
+		}
+
+		std::vector<uint64_t> bits = bitmapOf(a);
+		if (b.kind == Kind::Array) {
+			for (uint16_t low : b.values)
+				bits[low >> 6] &= ~(uint64_t(1) << (low & 63));
+		}
+		else {
+			std::vector<uint64_t> mask = bitmapOf(b);
+			for (size_t i = 0; i < _bitmapWords; ++i)
+				bits[i] &= ~mask[i];
+		}
+		return fromBitmap(std::move(bits));
+	}
+
+	//index of the chunk holding high, or _keys.size()
+	size_t findChunk(uint16_t high) const {
+		auto it = std::lower_bound(_keys.begin(), _keys.end(), high);
+		return it != _keys.end() && *it == high ? it - _keys.begin() : _keys.size();
+	}
+
+	void assign(std::vector<uint16_t>&& keys, std::vector<Container>&& chunks) {
+		_keys = std::move(keys);
+		_chunks = std::move(chunks);
+		_size = 0;
+		for (const Container& c : _chunks)
+			_size += c.cardinality;
+	}
+
+public:
+	bool contains(uint32_t value) const {
+		size_t i = findChunk(static_cast<uint16_t>(value >> 16));
+		return i != _keys.size() && containerContains(_chunks[i], static_cast<uint16_t>(value));
+	}
+
+	//false if the value is already present
+	bool insert(uint32_t value) {
+		uint16_t high = static_cast<uint16_t>(value >> 16);
+		uint16_t low = static_cast<uint16_t>(value);
+
+		auto it = std::lower_bound(_keys.begin(), _keys.end(), high);
+		size_t i = it - _keys.begin();
+		if (it == _keys.end() || *it != high) {
+			_keys.insert(it, high);
+			_chunks.insert(_chunks.begin() + i, Container());
+		}
+
+		Container& c = _chunks[i];
+		if (c.kind == Kind::Run) {
+			if (containerContains(c, low))
+				return false;
+			unpackRun(c);
+		}
+
+		if (c.kind == Kind::Array) {
+			auto pos = std::lower_bound(c.values.begin(), c.values.end(), low);
+			if (pos != c.values.end() && *pos == low)
+				return false;
+			c.values.insert(pos, low);
+		}
+		else {
+			uint64_t& word = c.bits[low >> 6];
+			uint64_t bit = uint64_t(1) << (low & 63);
+			if (word & bit)
+				return false;
+			word |= bit;
+		}
+
+		++c.cardinality;
+		++_size;
+		normalize(c);
+		return true;
+	}
+
+	//false if the value is absent
+	bool erase(uint32_t value) {
+		uint16_t low = static_cast<uint16_t>(value);
+		size_t i = findChunk(static_cast<uint16_t>(value >> 16));
+		if (i == _keys.size())
+			return false;
+
+		Container& c = _chunks[i];
+		if (c.kind == Kind::Run) {
+			if (!containerContains(c, low))
+				return false;
+			unpackRun(c);
+		}
+
+		if (c.kind == Kind::Array) {
+			auto pos = std::lower_bound(c.values.begin(), c.values.end(), low);
+			if (pos == c.values.end() || *pos != low)
+				return false;
+			c.values.erase(pos);
+		}
+		else {
+			uint64_t& word = c.bits[low >> 6];
+			uint64_t bit = uint64_t(1) << (low & 63);
+			if (!(word & bit))
+				return false;
+			word &= ~bit;
+		}
+
+		--_size;
+		if (--c.cardinality == 0) {
+			_keys.erase(_keys.begin() + i);
+			_chunks.erase(_chunks.begin() + i);
+		}
+		else
+			normalize(c);
+		return true;
+	}
+
+	size_t size() const {
+		return _size;
+	}
+
+	bool empty() const {
+		return _size == 0;
+	}
+
+	void clear() {
+		_keys.clear();
+		_chunks.clear();
+		_size = 0;
+	}
+
+	void union_with(const RoaringSet& other) {
+		std::vector<uint16_t> keys;
+		std::vector<Container> chunks;
+		size_t i = 0, j = 0;
+
+		while (i < _keys.size() || j < other._keys.size()) {
+			if (j == other._keys.size() || (i < _keys.size() && _keys[i] < other._keys[j])) {
+				keys.push_back(_keys[i]);
+				chunks.push_back(std::move(_chunks[i++]));
+			}
+			else if (i == _keys.size() || other._keys[j] < _keys[i]) {
+				keys.push_back(other._keys[j]);
+				chunks.push_back(other._chunks[j++]);
+			}
+			else {
+				keys.push_back(_keys[i]);
+				chunks.push_back(unite(_chunks[i++], other._chunks[j++]));
+			}
+		}
+		assign(std::move(keys), std::move(chunks));
+	}
+
+	void intersect_with(const RoaringSet& other) {
+		std::vector<uint16_t> keys;
+		std::vector<Container> chunks;
+
+		for (size_t i = 0, j = 0; i < _keys.size() && j < other._keys.size();) {
+			if (_keys[i] < other._keys[j])
+				++i;
+			else if (other._keys[j] < _keys[i])
+				++j;
+			else {
+				Container c = intersect(_chunks[i], other._chunks[j]);
+				if (c.cardinality > 0) {
+					keys.push_back(_keys[i]);
+					chunks.push_back(std::move(c));
+				}
+				++i;
+				++j;
+			}
+		}
+		assign(std::move(keys), std::move(chunks));
+	}
+
+	void difference(const RoaringSet& other) {
+		std::vector<uint16_t> keys;
+		std::vector<Container> chunks;
+
+		for (size_t i = 0, j = 0; i < _keys.size(); ++i) {
+			while (j < other._keys.size() && other._keys[j] < _keys[i])
+				++j;
+
+			if (j < other._keys.size() && other._keys[j] == _keys[i]) {
+				Container c = subtract(_chunks[i], other._chunks[j]);
+				if (c.cardinality == 0)
+					continue;
+				chunks.push_back(std::move(c));
+			}
+			else
+				chunks.push_back(std::move(_chunks[i]));
+			keys.push_back(_keys[i]);
+		}
+		assign(std::move(keys), std::move(chunks));
+	}
+
+	//turns chunks into run lists where that is smaller, and back where it is not
+	void run_optimize() {
+		for (Container& c : _chunks) {
+			size_t run_bytes = 4 * countRuns(c);
+			size_t plain_bytes = c.cardinality <= _arrayLimit ? 2 * c.cardinality : _bitmapWords * 8;
+
+			if (run_bytes < plain_bytes) {
+				if (c.kind != Kind::Run)
+					toRun(c);
+			}
+			else
+				unpackRun(c);
+		}
+	}
+
+	template<typename F>
+	void for_each(F&& f) const {
+		for (size_t i = 0; i < _keys.size(); ++i)
+			forEach(_chunks[i], uint32_t(_keys[i]) << 16, f);
+	}
+
+	std::vector<uint32_t> to_vector() const {
+		std::vector<uint32_t> result;
+		result.reserve(_size);
+		for_each([&](uint32_t value) { result.push_back(value); });
+		return result;
+	}
+
+	size_t memory_bytes() const {
+		size_t bytes = sizeof(*this) + _keys.capacity() * sizeof(uint16_t) + _chunks.capacity() * sizeof(Container);
+		for (const Container& c : _chunks)
+			bytes += c.values.capacity() * sizeof(uint16_t) + c.bits.capacity() * sizeof(uint64_t);
+		return bytes;
+	}
+};